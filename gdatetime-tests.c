@@ -18,6 +18,9 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
@@ -132,6 +135,297 @@ test_GDateTime_is_leap_year (void)
     }
 }
 
+static void
+test_GDateTime_leap_seconds (void)
+{
+  GDateTime *before,
+            *leap,
+            *after;
+  GTimeZone *tz;
+  GTimeSpan  ts;
+
+  before = g_date_time_new_full_with_zone (NULL, 2016, 12, 31, 23, 59, 59);
+  leap = g_date_time_new_full_with_zone (NULL, 2016, 12, 31, 23, 59, 60);
+  after = g_date_time_new_full_with_zone (NULL, 2017, 1, 1, 0, 0, 0);
+
+  g_assert_cmpint (g_date_time_get_hour (leap), ==, 23);
+  g_assert_cmpint (g_date_time_get_minute (leap), ==, 59);
+  g_assert_cmpint (g_date_time_get_second (leap), ==, 60);
+
+  g_assert_cmpint (g_date_time_to_tai (before), ==, 1483228799 + 36);
+  g_assert_cmpint (g_date_time_to_tai (leap), ==, 1483228800 + 36);
+  g_assert_cmpint (g_date_time_to_tai (after), ==, 1483228800 + 37);
+  g_assert_cmpint (g_date_time_to_gps (after), ==, 1167264018);
+
+  g_date_time_diff (before, after, &ts);
+  g_assert_cmpint (ts, ==, G_TIME_SPAN_SECOND);
+  g_date_time_diff_with_leap_seconds (before, after, &ts);
+  g_assert_cmpint (ts, ==, 2 * G_TIME_SPAN_SECOND);
+  g_date_time_diff_with_leap_seconds (leap, after, &ts);
+  g_assert_cmpint (ts, ==, G_TIME_SPAN_SECOND);
+
+  g_date_time_unref (before);
+  g_date_time_unref (leap);
+  g_date_time_unref (after);
+
+  /* The leap second survives a round trip through TAI and GPS time */
+  leap = g_date_time_new_from_tai (1483228800 + 36);
+  g_assert_cmpint (g_date_time_get_day_of_month (leap), ==, 31);
+  g_assert_cmpint (g_date_time_get_second (leap), ==, 60);
+  g_date_time_unref (leap);
+
+  before = g_date_time_new_from_gps (1167264016);
+  after = g_date_time_new_from_gps (1167264018);
+  g_assert_cmpint (g_date_time_get_second (before), ==, 59);
+  g_assert_cmpint (g_date_time_get_year (after), ==, 2017);
+  g_assert_cmpint (g_date_time_get_second (after), ==, 0);
+  g_assert_cmpint (g_date_time_to_gps (before), ==, 1167264016);
+  g_date_time_unref (before);
+  g_date_time_unref (after);
+
+  /* Instants in other zones count the same leap seconds */
+  tz = g_time_zone_new ("+01:00");
+  before = g_date_time_new_full_with_zone (tz, 2017, 1, 1, 0, 59, 59);
+  after = g_date_time_new_full_with_zone (tz, 2017, 1, 1, 1, 0, 0);
+  g_date_time_diff_with_leap_seconds (before, after, &ts);
+  g_assert_cmpint (ts, ==, 2 * G_TIME_SPAN_SECOND);
+  g_date_time_unref (before);
+  g_date_time_unref (after);
+  g_time_zone_unref (tz);
+}
+
+static void
+test_GDateTime_is_daylight_savings (void)
+{
+  GDateTime *dt;
+  GTimeSpan  ts;
+  struct tm  tm;
+  gint       year,
+             month,
+             day;
+
+  /* Every zone, including the southern hemisphere, must agree with libc */
+  for (year = 2008; year <= 2010; year++)
+    for (month = 1; month <= 12; month++)
+      for (day = 1; day <= 28; day += 9)
+        {
+          memset (&tm, 0, sizeof (tm));
+          tm.tm_year = year - 1900;
+          tm.tm_mon = month - 1;
+          tm.tm_mday = day;
+          tm.tm_hour = 12;
+          tm.tm_isdst = -1;
+          mktime (&tm);
+
+          dt = g_date_time_new_full (year, month, day, 12, 0, 0);
+          g_assert_cmpint (tm.tm_isdst > 0, ==, g_date_time_is_daylight_savings (dt));
+          g_date_time_get_utc_offset (dt, &ts);
+          g_assert_cmpint (ts, ==, tm.tm_gmtoff * G_TIME_SPAN_SECOND);
+          g_date_time_unref (dt);
+        }
+}
+
+static gpointer
+test_GDateTime_allocator_func (gpointer data)
+{
+  GDateTime **dts = data;
+  gint        i;
+
+  for (i = 0; i < 1000; i++)
+    g_date_time_unref (dts [i]);
+
+  return NULL;
+}
+
+static void
+test_GDateTime_allocator (void)
+{
+  GDateTime  *dts [1000];
+  GHashTable *freed;
+  GThread    *thread;
+  guint64     hits,
+              misses,
+              hits2,
+              misses2;
+  gint        i,
+              n;
+
+  g_date_time_get_allocator_stats (&hits, &misses);
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    dts [i] = g_date_time_new_from_time_t (1000000000 + i);
+  g_date_time_get_allocator_stats (&hits2, &misses2);
+  g_assert_cmpint (hits2 + misses2 - hits - misses, >=, G_N_ELEMENTS (dts));
+
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    {
+      g_assert_cmpint (g_date_time_to_time_t (dts [i]), ==, 1000000000 + i);
+      g_date_time_unref (dts [i]);
+    }
+
+  /* Recycled objects are mostly found without visiting the depot */
+  g_date_time_get_allocator_stats (&hits, &misses);
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    dts [i] = g_date_time_new_from_time_t (1000000000 + i);
+  g_date_time_get_allocator_stats (&hits2, &misses2);
+  g_assert_cmpint (hits2 - hits, >=, 900);
+  g_assert_cmpint (misses2 - misses, <, 100);
+
+  /* Objects freed by another thread come back through the depot */
+  freed = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    g_hash_table_insert (freed, dts [i], dts [i]);
+  thread = g_thread_create (test_GDateTime_allocator_func, dts, TRUE, NULL);
+  g_thread_join (thread);
+
+  for (i = 0, n = 0; i < G_N_ELEMENTS (dts); i++)
+    {
+      dts [i] = g_date_time_new_from_time_t (1000000000 + i);
+      if (g_hash_table_lookup (freed, dts [i]))
+        n++;
+    }
+  g_assert_cmpint (n, >=, 800);
+
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    g_date_time_unref (dts [i]);
+  g_hash_table_destroy (freed);
+
+  if (g_test_perf ())
+    {
+      GDateTime *dt,
+                *dt2;
+      GTimer    *timer;
+
+      dt = g_date_time_new_from_time_t (1000000000);
+      timer = g_timer_new ();
+      for (i = 0; i < 10000000; i++)
+        {
+          dt2 = g_date_time_copy (dt);
+          g_date_time_unref (dt2);
+        }
+      g_timer_stop (timer);
+      g_test_minimized_result (g_timer_elapsed (timer, NULL) * 100,
+                               "%.1f ns per copy and unref",
+                               g_timer_elapsed (timer, NULL) * 100);
+      g_timer_destroy (timer);
+      g_date_time_unref (dt);
+    }
+}
+
+static void
+test_GDateTime_arena (void)
+{
+  GDateTimeArena *arena,
+                 *inner;
+  GDateTime      *dts [1000],
+                 *dt,
+                 *dt2;
+  guint64         hits,
+                  misses,
+                  hits2,
+                  misses2;
+  GDateTimeValue  value;
+  GTimeSpan       ts;
+  gint            i;
+
+  arena = g_date_time_arena_new ();
+  g_date_time_arena_push_thread_default (arena);
+
+  /* Arena objects do not touch the magazines, and unref does nothing */
+  g_date_time_get_allocator_stats (&hits, &misses);
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    {
+      dt = g_date_time_new_full (2010, 1, 1, 0, 0, 0);
+      dts [i] = g_date_time_add_days (dt, i);
+      g_date_time_unref (dt);
+      g_date_time_ref (dts [i]);
+      g_date_time_unref (dts [i]);
+      g_date_time_unref (dts [i]);
+    }
+  g_date_time_get_allocator_stats (&hits2, &misses2);
+  g_assert_cmpint (hits2, ==, hits);
+  g_assert_cmpint (misses2, ==, misses);
+
+  /* Whole days apart, give or take a change of daylight savings */
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    {
+      g_assert_cmpint (g_date_time_get_hour (dts [i]), ==, 0);
+      g_date_time_diff (dts [0], dts [i], &ts);
+      g_assert_cmpint ((ts + 12 * G_TIME_SPAN_HOUR) / G_TIME_SPAN_DAY, ==, i);
+    }
+
+  /* Objects made from a value stay within the arena */
+  g_date_time_get_value (dts [0], &value);
+  dt = g_date_time_new_from_value (&value);
+  g_assert (g_date_time_equal (dt, dts [0]));
+  g_date_time_unref (dt);
+  g_date_time_get_allocator_stats (&hits2, &misses2);
+  g_assert_cmpint (hits2, ==, hits);
+  g_assert_cmpint (misses2, ==, misses);
+
+  /* Nested arenas are used innermost first */
+  inner = g_date_time_arena_new ();
+  g_date_time_arena_push_thread_default (inner);
+  dt = g_date_time_copy (dts [0]);
+  g_assert (g_date_time_equal (dt, dts [0]));
+  g_date_time_arena_pop_thread_default (inner);
+  g_date_time_arena_free (inner);
+
+  g_date_time_arena_pop_thread_default (arena);
+
+  /* Outside the arena, objects are counted again */
+  dt = g_date_time_copy (dts [G_N_ELEMENTS (dts) - 1]);
+  g_assert (g_date_time_equal (dt, dts [G_N_ELEMENTS (dts) - 1]));
+  dt2 = g_date_time_ref (dt);
+  g_date_time_unref (dt);
+  g_assert_cmpint (g_date_time_get_year (dt2), ==, 2012);
+  g_date_time_unref (dt2);
+
+  g_date_time_arena_free (arena);
+
+  /* Nothing of the freed arena is handed out again */
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    dts [i] = g_date_time_new_full (2010, 1, 1, 0, 0, 0);
+  for (i = 0; i < G_N_ELEMENTS (dts); i++)
+    g_date_time_unref (dts [i]);
+
+  if (g_test_perf ())
+    {
+      GTimer *timer;
+      gint    hours = 0;
+
+      timer = g_timer_new ();
+      for (i = 0; i < 1000000; i++)
+        {
+          dt = g_date_time_new_full (2010, 1, 1, i % 23, 0, 0);
+          dt2 = g_date_time_add_hours (dt, 1);
+          hours += g_date_time_get_hour (dt2);
+          g_date_time_unref (dt2);
+          g_date_time_unref (dt);
+        }
+      g_timer_stop (timer);
+      g_test_message ("Unref: %.3f seconds", g_timer_elapsed (timer, NULL));
+
+      g_timer_start (timer);
+      arena = g_date_time_arena_new ();
+      g_date_time_arena_push_thread_default (arena);
+      for (i = 0; i < 1000000; i++)
+        {
+          dt = g_date_time_new_full (2010, 1, 1, i % 23, 0, 0);
+          dt2 = g_date_time_add_hours (dt, 1);
+          hours -= g_date_time_get_hour (dt2);
+        }
+      g_date_time_arena_pop_thread_default (arena);
+      g_date_time_arena_free (arena);
+      g_timer_stop (timer);
+      g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                               "Arena: %.3f seconds",
+                               g_timer_elapsed (timer, NULL));
+      g_timer_destroy (timer);
+
+      g_assert_cmpint (hours, ==, 0);
+    }
+}
+
 static void
 test_GDateTime_compare (void)
 {
@@ -160,6 +454,42 @@ test_GDateTime_compare (void)
   g_date_time_unref (dt2);
 
   g_date_time_unref (dt1);
+
+  if (g_test_perf ())
+    {
+      GDateTime *dts [1000];
+      GTimeSpan  ts,
+                 total = 0;
+      GTimer    *timer;
+      gint       j,
+                 n = 0;
+      guint      hash = 0;
+
+      for (i = 0; i < G_N_ELEMENTS (dts); i++)
+        dts [i] = g_date_time_new_full (1000 + (i * 7) % 2000, 1 + i % 12,
+                                        1 + i % 28, i % 24, i % 60, i % 60);
+
+      /* Every pair, a million times each */
+      timer = g_timer_new ();
+      for (i = 0; i < G_N_ELEMENTS (dts); i++)
+        for (j = 0; j < G_N_ELEMENTS (dts); j++)
+          {
+            n += g_date_time_compare (dts [i], dts [j]);
+            n += g_date_time_equal (dts [i], dts [j]);
+            hash += g_date_time_hash (dts [j]);
+            g_date_time_diff (dts [i], dts [j], &ts);
+            total += ts;
+          }
+      g_timer_stop (timer);
+      g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                               "compare, equal, hash and diff: %.3f seconds "
+                               "(%d, %u, %" G_GINT64_FORMAT ")",
+                               g_timer_elapsed (timer, NULL), n, hash, total);
+      g_timer_destroy (timer);
+
+      for (i = 0; i < G_N_ELEMENTS (dts); i++)
+        g_date_time_unref (dts [i]);
+    }
 }
 
 static void
@@ -198,7 +528,10 @@ test_GDateTime_date (void)
 static void
 test_GDateTime_equal (void)
 {
-  GDateTime *dt1, *dt2;
+  GDateTime      *dt1, *dt2;
+  GTimeZone      *berlin, *ny;
+  GDateTimeValue  v1, v2;
+  GTimeSpan       ts;
 
   dt1 = g_date_time_new_from_date (2009, 10, 19);
   dt2 = g_date_time_new_from_date (2009, 10, 19);
@@ -211,6 +544,31 @@ test_GDateTime_equal (void)
   g_assert (!g_date_time_equal (dt1, dt2));
   g_date_time_unref (dt1);
   g_date_time_unref (dt2);
+
+  /* The same instant in different zones */
+  berlin = g_time_zone_new ("Europe/Berlin");
+  ny = g_time_zone_new ("America/New_York");
+  dt1 = g_date_time_new_full_with_zone (berlin, 2010, 6, 1, 12, 0, 0);
+  dt2 = g_date_time_to_zone (dt1, ny);
+  g_assert_cmpint (g_date_time_get_hour (dt2), ==, 6);
+  g_assert (g_date_time_equal (dt1, dt2));
+  g_assert_cmpint (g_date_time_compare (dt1, dt2), ==, 0);
+  g_assert_cmpint (g_date_time_hash (dt1), ==, g_date_time_hash (dt2));
+  g_date_time_diff (dt1, dt2, &ts);
+  g_assert_cmpint (ts, ==, 0);
+  g_date_time_get_value (dt1, &v1);
+  g_date_time_get_value (dt2, &v2);
+  g_assert (g_date_time_value_equal (&v1, &v2));
+  g_date_time_unref (dt2);
+
+  /* Earlier by the clock but later in time */
+  dt2 = g_date_time_new_full_with_zone (ny, 2010, 6, 1, 7, 0, 0);
+  g_assert (!g_date_time_equal (dt1, dt2));
+  g_assert_cmpint (g_date_time_compare (dt1, dt2), <, 0);
+  g_date_time_unref (dt1);
+  g_date_time_unref (dt2);
+  g_time_zone_unref (berlin);
+  g_time_zone_unref (ny);
 }
 
 static void
@@ -601,6 +959,12 @@ test_GDateTime_add_seconds (void)
 static void
 test_GDateTime_diff (void)
 {
+  GDateTime *begin,
+            *end;
+  GTimeZone *berlin;
+  GTimeSpan  span;
+  gchar     *saved;
+
 #define TEST_DIFF(y,m,d,y2,m2,d2,u) G_STMT_START { \
   GDateTime *dt1, *dt2; \
   GTimeSpan  ts = 0; \
@@ -617,7 +981,68 @@ test_GDateTime_diff (void)
   TEST_DIFF (2008, 2, 28, 2008, 2, 29, G_TIME_SPAN_DAY);
   TEST_DIFF (2008, 2, 29, 2008, 2, 28, -G_TIME_SPAN_DAY);
 
-  /* TODO: Add usec tests */
+  /* Local dates across a change of offset are apart by the elapsed time,
+   * not by whole days */
+  saved = g_strdup (g_getenv ("TZ"));
+  g_setenv ("TZ", "Europe/Berlin", TRUE);
+  g_time_zone_refresh ();
+  TEST_DIFF (2010, 3, 27, 2010, 3, 28, G_TIME_SPAN_DAY);
+  TEST_DIFF (2010, 3, 28, 2010, 3, 29, 23 * G_TIME_SPAN_HOUR);
+  TEST_DIFF (2010, 10, 31, 2010, 11, 1, 25 * G_TIME_SPAN_HOUR);
+  if (saved)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+  g_time_zone_refresh ();
+
+  /* Far apart UTC dates are counted in whole days */
+  begin = g_date_time_new_full_with_zone (NULL, 1, 1, 1, 0, 0, 0);
+  end = g_date_time_new_full_with_zone (NULL, 3001, 1, 1, 0, 0, 0);
+  g_date_time_diff (begin, end, &span);
+  g_assert_cmpint (span, ==, G_TIME_SPAN_DAY * 1095727);
+  g_date_time_unref (end);
+  g_date_time_unref (begin);
+
+  begin = g_date_time_new_full_with_zone (NULL, 2009, 12, 31, 23, 59, 59);
+  end = g_date_time_add_milliseconds (begin, 1500);
+  g_date_time_diff (begin, end, &span);
+  g_assert_cmpint (span, ==, 1500 * G_TIME_SPAN_MILLISECOND);
+  g_date_time_diff (end, begin, &span);
+  g_assert_cmpint (span, ==, -1500 * G_TIME_SPAN_MILLISECOND);
+  g_assert_cmpint (g_date_time_get_year (end), ==, 2010);
+  g_assert_cmpint (g_date_time_get_millisecond (end), ==, 500);
+  g_date_time_unref (end);
+  g_date_time_unref (begin);
+
+  /* Berlin skips from 02:00 to 03:00 on 2010-03-28 */
+  berlin = g_time_zone_new ("Europe/Berlin");
+  begin = g_date_time_new_full_with_zone (berlin, 2010, 3, 28, 0, 0, 0);
+  end = g_date_time_new_full_with_zone (berlin, 2010, 3, 28, 4, 0, 0);
+  g_date_time_diff (begin, end, &span);
+  g_assert_cmpint (span, ==, 3 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (end);
+
+  end = g_date_time_add_hours (begin, 3);
+  g_assert_cmpint (g_date_time_get_hour (end), ==, 4);
+  g_date_time_diff (begin, end, &span);
+  g_assert_cmpint (span, ==, 3 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (end);
+
+  /* Days keep the wall clock time */
+  end = g_date_time_add_days (begin, 1);
+  g_assert_cmpint (g_date_time_get_hour (end), ==, 0);
+  g_date_time_diff (begin, end, &span);
+  g_assert_cmpint (span, ==, 23 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (end);
+
+  /* A skipped wall clock time is read with the offset before the gap */
+  end = g_date_time_new_full_with_zone (berlin, 2010, 3, 28, 2, 30, 0);
+  g_assert_cmpint (g_date_time_get_hour (end), ==, 3);
+  g_assert_cmpint (g_date_time_get_minute (end), ==, 30);
+  g_date_time_unref (end);
+  g_date_time_unref (begin);
+  g_time_zone_unref (berlin);
 }
 
 static void
@@ -650,6 +1075,60 @@ test_GDateTime_get_second (void)
   g_date_time_unref (dt);
 }
 
+static void
+test_GDateTime_local_zone (void)
+{
+  GDateTimeValue  value;
+  GDateTime      *dt1,
+                 *dt2;
+  GTimeSpan       ts;
+  gchar          *saved;
+
+  saved = g_strdup (g_getenv ("TZ"));
+  g_setenv ("TZ", "Europe/Berlin", TRUE);
+  g_time_zone_refresh ();
+
+  /* Instants are only marked as local, without looking the zone up */
+  dt1 = g_date_time_new_from_time_t (1262304000);
+  g_date_time_get_value (dt1, &value);
+  g_assert (value.local);
+  g_assert_cmpuint (value.zone, ==, 0);
+  g_date_time_unref (dt1);
+
+  dt1 = g_date_time_now ();
+  g_date_time_get_value (dt1, &value);
+  g_assert (value.local);
+  g_assert_cmpuint (value.zone, ==, 0);
+  g_date_time_unref (dt1);
+
+  /* Local values from an instant and from a wall clock time alike keep
+   * their instant, and show it in the local zone found by a refresh */
+  dt1 = g_date_time_new_from_time_t (1262304000);
+  dt2 = g_date_time_new_full (2010, 1, 1, 1, 0, 0);
+  g_assert (g_date_time_equal (dt1, dt2));
+  g_assert_cmpint (g_date_time_get_hour (dt1), ==, 1);
+  g_assert_cmpint (g_date_time_get_hour (dt2), ==, 1);
+
+  g_setenv ("TZ", "Asia/Tokyo", TRUE);
+  g_time_zone_refresh ();
+  g_assert (g_date_time_equal (dt1, dt2));
+  g_assert_cmpint (g_date_time_to_time_t (dt1), ==, 1262304000);
+  g_assert_cmpint (g_date_time_to_time_t (dt2), ==, 1262304000);
+  g_assert_cmpint (g_date_time_get_hour (dt1), ==, 9);
+  g_assert_cmpint (g_date_time_get_hour (dt2), ==, 9);
+  g_date_time_get_utc_offset (dt2, &ts);
+  g_assert_cmpint (ts, ==, 9 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (dt1);
+  g_date_time_unref (dt2);
+
+  if (saved)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+  g_time_zone_refresh ();
+}
+
 static void
 test_GDateTime_new_from_date (void)
 {
@@ -677,6 +1156,93 @@ test_GDateTime_new_full (void)
   g_date_time_unref (dt);
 }
 
+static void
+test_GDateTime_new_full_with_zone (void)
+{
+  GDateTime *dt;
+  GTimeZone *tz;
+  GTimeSpan  ts;
+  gchar     *p;
+
+  if (!(tz = g_time_zone_new ("Europe/Berlin")))
+    return;
+
+  dt = g_date_time_new_full_with_zone (tz, 2009, 12, 11, 12, 11, 10);
+  g_assert_cmpint (12, ==, g_date_time_get_hour (dt));
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, G_TIME_SPAN_HOUR);
+  g_assert (!g_date_time_is_daylight_savings (dt));
+  p = g_date_time_printf (dt, "%z");
+  g_assert_cmpstr (p, ==, "CET");
+  g_free (p);
+  g_date_time_unref (dt);
+
+  dt = g_date_time_new_full_with_zone (tz, 2009, 7, 11, 12, 11, 10);
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, 2 * G_TIME_SPAN_HOUR);
+  g_assert (g_date_time_is_daylight_savings (dt));
+  g_assert_cmpint (g_date_time_to_time_t (dt), ==, 1247307070);
+  g_date_time_unref (dt);
+
+  g_time_zone_unref (tz);
+}
+
+static void
+test_GDateTime_new_full_with_resolve (void)
+{
+  GDateTime *dt;
+  GTimeZone *tz;
+  GTimeSpan  ts;
+
+  if (!(tz = g_time_zone_new ("America/New_York")))
+    return;
+
+  /* 01:30 happens twice on 2010-11-07 */
+  dt = g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_EARLIER,
+                                          2010, 11, 7, 1, 30, 0);
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, -4 * G_TIME_SPAN_HOUR);
+  g_assert (g_date_time_is_daylight_savings (dt));
+  g_assert_cmpint (g_date_time_to_time_t (dt), ==, 1289107800);
+  g_date_time_unref (dt);
+
+  dt = g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_LATER,
+                                          2010, 11, 7, 1, 30, 0);
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, -5 * G_TIME_SPAN_HOUR);
+  g_assert_cmpint (g_date_time_to_time_t (dt), ==, 1289111400);
+  g_date_time_unref (dt);
+
+  g_assert (g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_REJECT,
+                                               2010, 11, 7, 1, 30, 0) == NULL);
+
+  /* 02:30 never happens on 2010-03-14 */
+  dt = g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_SHIFT_FORWARD,
+                                          2010, 3, 14, 2, 30, 0);
+  g_assert_cmpint (g_date_time_get_hour (dt), ==, 3);
+  g_assert_cmpint (g_date_time_get_minute (dt), ==, 0);
+  g_assert_cmpint (g_date_time_to_time_t (dt), ==, 1268550000);
+  g_date_time_unref (dt);
+
+  dt = g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_LATER,
+                                          2010, 3, 14, 2, 30, 0);
+  g_assert_cmpint (g_date_time_get_hour (dt), ==, 3);
+  g_assert_cmpint (g_date_time_get_minute (dt), ==, 30);
+  g_date_time_unref (dt);
+
+  dt = g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_EARLIER,
+                                          2010, 3, 14, 2, 30, 0);
+  g_assert_cmpint (g_date_time_get_hour (dt), ==, 1);
+  g_assert_cmpint (g_date_time_get_minute (dt), ==, 30);
+  g_assert (!g_date_time_is_daylight_savings (dt));
+  g_date_time_unref (dt);
+
+  g_assert (g_date_time_new_full_with_resolve (tz, G_TIME_RESOLVE_REJECT,
+                                               2010, 3, 14, 2, 30, 0) == NULL);
+
+  g_time_zone_unref (tz);
+}
+
 static void
 test_GDateTime_unref (void)
 {
@@ -715,6 +1281,131 @@ test_GDateTime_utc_now (void)
   g_date_time_unref (dt);
 }
 
+static void
+test_GDateTime_value (void)
+{
+  GDateTimeValue  v,
+                  v2;
+  GDateTime      *dt,
+                 *dt2;
+  GTimeZone      *utc,
+                 *ny;
+  GTimeSpan       ts;
+  GTimer         *timer;
+  gchar          *str;
+  gint            i,
+                  hours;
+
+  utc = g_time_zone_new_utc ();
+
+  /* No bigger than a GDateTime */
+  g_assert_cmpuint (sizeof (GDateTimeValue), <=, 16);
+
+  g_assert (g_date_time_value_init_full (&v, utc, 2009, 12, 31, 23, 0, 0));
+  g_date_time_value_add_hours (&v, 2, &v2);
+  g_assert_cmpint (2010, ==, g_date_time_value_get_year (&v2));
+  g_assert_cmpint (1, ==, g_date_time_value_get_month (&v2));
+  g_assert_cmpint (1, ==, g_date_time_value_get_day_of_month (&v2));
+  g_assert_cmpint (1, ==, g_date_time_value_get_hour (&v2));
+  g_assert_cmpint (g_date_time_value_compare (&v, &v2), <, 0);
+  g_assert_cmpint (g_date_time_value_compare (&v2, &v), >, 0);
+  g_assert (!g_date_time_value_equal (&v, &v2));
+
+  /* Results may be stored over the operand */
+  g_date_time_value_add_months (&v, 2, &v);
+  g_assert_cmpint (2, ==, g_date_time_value_get_month (&v));
+  g_assert_cmpint (28, ==, g_date_time_value_get_day_of_month (&v));
+  g_assert_cmpint (23, ==, g_date_time_value_get_hour (&v));
+
+  g_date_time_value_add_full (&v, 0, 0, 0, 0, 59, 60, &v);
+  str = g_date_time_value_printf (&v, "%Y-%m-%d %H:%M:%S");
+  g_assert_cmpstr (str, ==, "2010-03-01 00:00:00");
+  g_free (str);
+
+  /* Round trips through GDateTime */
+  dt = g_date_time_new_from_value (&v);
+  dt2 = g_date_time_new_full_with_zone (utc, 2010, 3, 1, 0, 0, 0);
+  g_assert (g_date_time_equal (dt, dt2));
+  g_date_time_get_value (dt2, &v2);
+  g_assert (g_date_time_value_equal (&v, &v2));
+  g_assert_cmpint (g_date_time_value_to_time_t (&v2), ==,
+                   g_date_time_to_time_t (dt2));
+  g_date_time_unref (dt2);
+  g_date_time_unref (dt);
+
+  if ((ny = g_time_zone_new ("America/New_York")))
+    {
+      g_date_time_value_init_from_time_t (&v, ny, 1247358600);
+      g_assert_cmpint (20, ==, g_date_time_value_get_hour (&v));
+      g_assert_cmpint (30, ==, g_date_time_value_get_minute (&v));
+      g_assert (g_date_time_value_is_daylight_savings (&v));
+      g_date_time_value_get_utc_offset (&v, &ts);
+      g_assert_cmpint (ts, ==, -4 * G_TIME_SPAN_HOUR);
+
+      g_date_time_value_to_zone (&v, NULL, &v2);
+      g_assert_cmpint (0, ==, g_date_time_value_get_hour (&v2));
+      g_assert_cmpint (12, ==, g_date_time_value_get_day_of_month (&v2));
+      g_assert_cmpint (g_date_time_value_to_time_t (&v), ==,
+                       g_date_time_value_to_time_t (&v2));
+    }
+
+  if (g_test_perf ())
+    {
+      /* Parse, add an hour and read it back, with and without the heap */
+      timer = g_timer_new ();
+      for (i = 0, hours = 0; i < 1000000; i++)
+        {
+          dt = g_date_time_new_full_with_zone (utc, 2010, 1, 1, i % 23, 0, 0);
+          dt2 = g_date_time_add_hours (dt, 1);
+          hours += g_date_time_get_hour (dt2);
+          g_date_time_unref (dt2);
+          g_date_time_unref (dt);
+        }
+      g_timer_stop (timer);
+      g_test_message ("GDateTime: %.3f seconds", g_timer_elapsed (timer, NULL));
+
+      g_timer_start (timer);
+      for (i = 0; i < 1000000; i++)
+        {
+          g_date_time_value_init_full (&v, utc, 2010, 1, 1, i % 23, 0, 0);
+          g_date_time_value_add_hours (&v, 1, &v);
+          hours -= g_date_time_value_get_hour (&v);
+        }
+      g_timer_stop (timer);
+      g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                               "GDateTimeValue: %.3f seconds",
+                               g_timer_elapsed (timer, NULL));
+      g_timer_destroy (timer);
+
+      g_assert_cmpint (hours, ==, 0);
+    }
+}
+
+static void
+test_GDateTime_warm_up (void)
+{
+  const gchar *identifiers [] = { "Asia/Kathmandu", "Europe/Lisbon", NULL };
+  GTimeZone   *tz;
+  gint         i;
+
+  /* The background thread reads TZ, which later tests change */
+  if (g_test_trap_fork (0, 0))
+    {
+      g_date_time_warm_up (identifiers);
+      g_date_time_warm_up (NULL);
+
+      /* Zones still being loaded in the background are loaded here as well */
+      tz = g_time_zone_new ("Asia/Kathmandu");
+      g_assert (tz != NULL);
+      g_assert (g_time_zone_new ("Asia/Kathmandu") == tz);
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                     G_GINT64_CONSTANT (1262304000));
+      g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 20700);
+      exit (0);
+    }
+  g_test_trap_assert_passed ();
+}
+
 static void
 test_GDateTime_get_utc_offset (void)
 {
@@ -733,6 +1424,39 @@ test_GDateTime_get_utc_offset (void)
   g_date_time_unref (dt);
 }
 
+static void
+test_GDateTime_get_utc_offset_historic (void)
+{
+#define TEST_UTC_OFFSET(y,m,d) G_STMT_START { \
+  GDateTime *dt; \
+  GTimeSpan  ts; \
+  struct tm  tm; \
+  memset (&tm, 0, sizeof (tm)); \
+  tm.tm_year = (y) - 1900; \
+  tm.tm_mon = (m) - 1; \
+  tm.tm_mday = (d); \
+  tm.tm_hour = 12; \
+  tm.tm_isdst = -1; \
+  mktime (&tm); \
+  dt = g_date_time_new_full ((y), (m), (d), 12, 0, 0); \
+  g_date_time_get_utc_offset (dt, &ts); \
+  g_assert_cmpint (ts, ==, tm.tm_gmtoff * G_TIME_SPAN_SECOND); \
+  g_date_time_unref (dt); \
+} G_STMT_END
+
+  /* Outside of the range libc probing used to support.  glibc does not
+   * apply the rules of a POSIX $TZ before 1970, so only zoneinfo history
+   * can be compared there. */
+  if (!g_getenv ("TZ") || !strchr (g_getenv ("TZ"), ','))
+    {
+      TEST_UTC_OFFSET (1960, 1, 15);
+      TEST_UTC_OFFSET (1960, 7, 15);
+      TEST_UTC_OFFSET (1965, 12, 1);
+    }
+  TEST_UTC_OFFSET (2009, 7, 15);
+  TEST_UTC_OFFSET (2009, 12, 1);
+}
+
 static void
 test_GDateTime_to_timeval (void)
 {
@@ -792,6 +1516,52 @@ test_GDateTime_to_utc (void)
   g_date_time_unref (dt2);
 }
 
+static void
+test_GDateTime_to_zone (void)
+{
+  GDateTime *dt, *dt2, *dt3;
+  GTimeZone *berlin, *tokyo, *ny;
+
+  berlin = g_time_zone_new ("Europe/Berlin");
+  tokyo = g_time_zone_new ("Asia/Tokyo");
+  if (!berlin || !tokyo)
+    return;
+
+  dt = g_date_time_new_full_with_zone (berlin, 2009, 7, 11, 20, 30, 0);
+  dt2 = g_date_time_to_zone (dt, tokyo);
+  g_assert_cmpint (12, ==, g_date_time_get_day_of_month (dt2));
+  g_assert_cmpint (3, ==, g_date_time_get_hour (dt2));
+  g_assert_cmpint (30, ==, g_date_time_get_minute (dt2));
+  g_assert_cmpint (g_date_time_to_time_t (dt), ==, g_date_time_to_time_t (dt2));
+
+  dt3 = g_date_time_to_zone (dt2, NULL);
+  g_assert_cmpint (18, ==, g_date_time_get_hour (dt3));
+  g_date_time_unref (dt3);
+
+  dt3 = g_date_time_to_zone (dt2, berlin);
+  g_assert_cmpint (11, ==, g_date_time_get_day_of_month (dt3));
+  g_assert_cmpint (20, ==, g_date_time_get_hour (dt3));
+  g_date_time_unref (dt3);
+
+  g_date_time_unref (dt2);
+  g_date_time_unref (dt);
+  g_time_zone_unref (tokyo);
+  g_time_zone_unref (berlin);
+
+  if (!(ny = g_time_zone_new ("America/New_York")))
+    return;
+
+  /* 05:30 UTC is the first 01:30 in New York on 2010-11-07 */
+  dt = g_date_time_new_full_with_zone (NULL, 2010, 11, 7, 5, 30, 0);
+  dt2 = g_date_time_to_zone (dt, ny);
+  g_assert_cmpint (1, ==, g_date_time_get_hour (dt2));
+  g_assert (g_date_time_is_daylight_savings (dt2));
+  g_assert_cmpint (g_date_time_to_time_t (dt2), ==, 1289107800);
+  g_date_time_unref (dt2);
+  g_date_time_unref (dt);
+  g_time_zone_unref (ny);
+}
+
 #define g_assert_str_has_prefix(s,p) g_assert(g_str_has_prefix(s,p))
 
 static void
@@ -955,6 +1725,1278 @@ test_GDateTime_parse_with_format (void)
   TEST_PARSE_FORMAT ("%y/%m/%d", "09/10/24", 2009, 10, 24, 0, 0, 0);
   TEST_PARSE_FORMAT ("%t", "\t", 1, 1, 1, 0, 0, 0);
   TEST_PARSE_FORMAT ("%%", "%", 1, 1, 1, 0, 0, 0);
+  TEST_PARSE_FORMAT ("%H:%M:%S %Z", "12:00:00 PST", 1, 1, 1, 12, 0, 0);
+  TEST_PARSE_FORMAT ("%Y-%m-%dT%H:%M:%S%z", "2010-06-01T12:30:00+0530",
+                     2010, 6, 1, 12, 30, 0);
+
+#define TEST_PARSE_OFFSET(f,i,o) G_STMT_START { \
+  GDateTime *dt; \
+  GTimeSpan  ts; \
+  dt = g_date_time_parse_with_format ((f), (i)); \
+  g_assert (dt != NULL); \
+  g_date_time_get_utc_offset (dt, &ts); \
+  g_assert_cmpint (ts, ==, (o) * G_TIME_SPAN_SECOND); \
+  g_date_time_unref (dt); \
+} G_STMT_END
+
+  TEST_PARSE_OFFSET ("%d %Z", "01 PST", -28800);
+  TEST_PARSE_OFFSET ("%d %Z", "01 CEST", 7200);
+  TEST_PARSE_OFFSET ("%d %Z", "01 ChST", 36000);
+  TEST_PARSE_OFFSET ("%d %Z", "01 UTC", 0);
+  TEST_PARSE_OFFSET ("%d %z", "01 +0530", 19800);
+  TEST_PARSE_OFFSET ("%d %z", "01 +05:30", 19800);
+  TEST_PARSE_OFFSET ("%d %z", "01 -08", -28800);
+  TEST_PARSE_OFFSET ("%d %z", "01 Z", 0);
+  TEST_PARSE_OFFSET ("%d %z %d", "01 -0330 02", -12600);
+
+  /* The instant is that of the wall clock time in the parsed offset */
+  TEST_PARSE_OFFSET ("%H %Z", "12 NZST", 43200);
+
+  g_assert (g_date_time_parse_with_format ("%Z", "IST") == NULL);
+  g_assert (g_date_time_parse_with_format ("%Z", "ABCDEF") == NULL);
+  g_assert (g_date_time_parse_with_format ("%Z", "+0100") == NULL);
+  g_assert (g_date_time_parse_with_format ("%z", "0530") == NULL);
+  g_assert (g_date_time_parse_with_format ("%z", "+5") == NULL);
+  g_assert (g_date_time_parse_with_format ("%Q", "1") == NULL);
+}
+
+static void
+test_GTimeZone_builtin (void)
+{
+  GTimeZone *tz;
+  gchar     *saved;
+  gint       i;
+
+  /* Without a zoneinfo database only the snapshot can provide zones */
+  saved = g_strdup (g_getenv ("TZDIR"));
+  g_setenv ("TZDIR", "/nonexistent", TRUE);
+  g_time_zone_refresh ();
+
+  tz = g_time_zone_new ("Asia/Tokyo");
+#ifdef HAVE_BUILTIN_TZDATA
+  g_assert (tz != NULL);
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                 G_GINT64_CONSTANT (1262304000));
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 32400);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "JST");
+#else
+  g_assert (tz == NULL);
+#endif
+
+  /* POSIX rules are still understood */
+  tz = g_time_zone_new ("JST-9");
+  g_assert (tz != NULL);
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, 0);
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 32400);
+
+  if (saved)
+    g_setenv ("TZDIR", saved, TRUE);
+  else
+    g_unsetenv ("TZDIR");
+  g_free (saved);
+  g_time_zone_refresh ();
+}
+
+static void
+test_GTimeZone_cache_file (void)
+{
+  GTimeZone *tz1,
+            *tz2;
+  gchar     *saved,
+            *saved_tzdir,
+            *dir,
+            *source,
+            *filename,
+            *contents,
+            *contents2;
+  gsize      length,
+             length2;
+  gint       i1,
+             i2;
+
+  /* Zones unknown to the zoneinfo database are probed from libc */
+  saved = g_strdup (g_getenv ("TZ"));
+  g_setenv ("TZ", "Nowhere/Special", TRUE);
+  g_time_zone_refresh ();
+  tz1 = g_time_zone_new_local ();
+  i1 = g_time_zone_find_interval (tz1, G_TIME_TYPE_UNIVERSAL, 0);
+
+  filename = g_build_filename (g_get_user_cache_dir (), "gtimezone",
+                               "Nowhere%2fSpecial", NULL);
+  g_assert (g_file_get_contents (filename, &contents, &length, NULL));
+  g_assert_cmpint (length, >, 8);
+  g_assert (memcmp (contents, "GTZcache", 8) == 0);
+  g_free (contents);
+
+  /* Later loads come from the cache and match the probed zone, which is
+   * then kept */
+  g_time_zone_refresh ();
+  tz2 = g_time_zone_new_local ();
+  g_assert (tz2 == tz1);
+  i2 = g_time_zone_find_interval (tz2, G_TIME_TYPE_UNIVERSAL, 0);
+  g_assert_cmpint (g_time_zone_get_offset (tz1, i1), ==,
+                   g_time_zone_get_offset (tz2, i2));
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz1, i1), ==,
+                   g_time_zone_get_abbreviation (tz2, i2));
+
+  /* A damaged cache file is ignored and written again */
+  g_assert (g_file_set_contents (filename, "GTZcache garbage", -1, NULL));
+  g_time_zone_refresh ();
+  tz2 = g_time_zone_new_local ();
+  i2 = g_time_zone_find_interval (tz2, G_TIME_TYPE_UNIVERSAL, 0);
+  g_assert_cmpint (g_time_zone_get_offset (tz1, i1), ==,
+                   g_time_zone_get_offset (tz2, i2));
+  g_assert (g_file_get_contents (filename, &contents, &length, NULL));
+  g_assert_cmpint (length, >, strlen ("GTZcache garbage"));
+  g_free (contents);
+  g_free (filename);
+
+  /* Changing the file libc reads the zone from makes the cache stale */
+  saved_tzdir = g_strdup (g_getenv ("TZDIR"));
+  dir = g_build_filename (g_get_tmp_dir (), "gtimezone-XXXXXX", NULL);
+  g_assert (mkdtemp (dir) != NULL);
+  source = g_build_filename (dir, "Libc", NULL);
+  filename = g_build_filename (g_get_user_cache_dir (), "gtimezone", "Libc",
+                               NULL);
+  g_setenv ("TZDIR", dir, TRUE);
+  g_setenv ("TZ", "Libc", TRUE);
+
+  g_assert (g_file_set_contents (source, "not a zoneinfo file", -1, NULL));
+  g_time_zone_refresh ();
+  g_time_zone_new_local ();
+  g_assert (g_file_get_contents (filename, &contents, &length, NULL));
+  g_assert (g_strstr_len (contents, length, dir) != NULL);
+
+  g_assert (g_file_set_contents (source, "still not a zoneinfo file", -1,
+                                 NULL));
+  g_time_zone_refresh ();
+  g_time_zone_new_local ();
+  g_assert (g_file_get_contents (filename, &contents2, &length2, NULL));
+  g_assert (length2 != length || memcmp (contents, contents2, length) != 0);
+  g_free (contents);
+  g_free (contents2);
+
+  g_unlink (filename);
+  g_unlink (source);
+  g_rmdir (dir);
+  g_free (filename);
+  g_free (source);
+  g_free (dir);
+
+  if (saved_tzdir)
+    g_setenv ("TZDIR", saved_tzdir, TRUE);
+  else
+    g_unsetenv ("TZDIR");
+  g_free (saved_tzdir);
+
+  if (saved)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+  g_time_zone_refresh ();
+}
+
+static void
+test_GTimeZone_cache_stats (void)
+{
+  GTimeZone *tz1,
+            *tz2;
+  guint      n_zones1,
+             n_zones2,
+             n_abbrs1,
+             n_abbrs2;
+  gsize      n_bytes1,
+             n_bytes2;
+  gint       i;
+
+  g_time_zone_refresh ();
+  tz1 = g_time_zone_new ("America/New_York");
+  g_assert (tz1 != NULL);
+  g_time_zone_get_cache_stats (&n_zones1, &n_abbrs1, &n_bytes1);
+  g_assert_cmpint (n_zones1, >, 0);
+  g_assert_cmpint (n_abbrs1, >, 0);
+
+  /* Another zone allocates its transitions but shares abbreviations */
+  tz2 = g_time_zone_new ("US/Eastern");
+  g_assert (tz2 != tz1);
+  g_time_zone_get_cache_stats (&n_zones2, &n_abbrs2, &n_bytes2);
+  g_assert_cmpint (n_zones2, ==, n_zones1 + 1);
+  g_assert_cmpint (n_abbrs2, ==, n_abbrs1);
+  g_assert_cmpint (n_bytes2, >, n_bytes1);
+
+  i = g_time_zone_find_interval (tz1, G_TIME_TYPE_UNIVERSAL, 0);
+  g_assert (g_time_zone_get_abbreviation (tz1, i) ==
+            g_time_zone_get_abbreviation (tz2, i));
+
+  g_time_zone_get_cache_stats (NULL, NULL, NULL);
+}
+
+static void
+test_GTimeZone_convert_times (void)
+{
+  GTimeZone *tz;
+  GTimer    *timer;
+  gint64    *times,
+            *converted;
+  gsize      n_times = 20000,
+             i;
+  gint       interval,
+             type;
+
+  tz = g_time_zone_new ("Europe/Berlin");
+  times = g_new (gint64, n_times);
+  converted = g_new (gint64, n_times);
+
+  /* Every half hour from 2009 on, across transitions and into the rule */
+  for (i = 0; i < n_times; i++)
+    times [i] = G_GINT64_CONSTANT (1230768000) + i * 1800;
+
+  for (type = G_TIME_TYPE_UNIVERSAL; type <= G_TIME_TYPE_LOCAL; type++)
+    {
+      g_time_zone_convert_times (tz, type, times, converted, n_times);
+      for (i = 0; i < n_times; i++)
+        {
+          interval = g_time_zone_find_interval (tz, type, times [i]);
+          g_assert_cmpint (converted [i] - times [i], ==,
+                           type == G_TIME_TYPE_LOCAL ?
+                             -g_time_zone_get_offset (tz, interval) :
+                             g_time_zone_get_offset (tz, interval));
+        }
+    }
+
+  /* Unsorted input, converted in place */
+  for (i = 0; i < n_times; i++)
+    times [i] = G_GINT64_CONSTANT (1230768000) + (i * 7919 % n_times) * 1800;
+  memcpy (converted, times, n_times * sizeof (gint64));
+  g_time_zone_convert_times (tz, G_TIME_TYPE_UNIVERSAL, converted, converted,
+                             n_times);
+  for (i = 0; i < n_times; i++)
+    {
+      interval = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                            times [i]);
+      g_assert_cmpint (converted [i] - times [i], ==,
+                       g_time_zone_get_offset (tz, interval));
+    }
+
+  g_time_zone_convert_times (tz, G_TIME_TYPE_UNIVERSAL, NULL, NULL, 0);
+
+  /* The last interval of a zone does not contain G_MAXINT64 */
+  times [0] = 0;
+  times [1] = times [2] = G_MAXINT64;
+  g_time_zone_convert_times (g_time_zone_new_utc (), G_TIME_TYPE_UNIVERSAL,
+                             times, converted, 3);
+  g_assert (memcmp (times, converted, 3 * sizeof (gint64)) == 0);
+
+  g_free (times);
+  g_free (converted);
+
+  if (g_test_perf ())
+    {
+      /* A column of ten million instants a second apart */
+      n_times = 10000000;
+      times = g_new (gint64, n_times);
+      converted = g_new (gint64, n_times);
+      for (i = 0; i < n_times; i++)
+        times [i] = G_GINT64_CONSTANT (1230768000) + i;
+
+      timer = g_timer_new ();
+      g_time_zone_convert_times (tz, G_TIME_TYPE_UNIVERSAL, times, converted,
+                                 n_times);
+      g_timer_stop (timer);
+      g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                               "%" G_GSIZE_FORMAT " instants: %.3f seconds",
+                               n_times, g_timer_elapsed (timer, NULL));
+      g_timer_destroy (timer);
+
+      g_free (times);
+      g_free (converted);
+    }
+}
+
+static void
+test_GTimeZone_days (void)
+{
+  GTimeZoneDays *days;
+  GTimeZone     *tz;
+  GTimer        *timer;
+  gint64        *times,
+                 t,
+                 local;
+  gint          *indices;
+  gsize          n_times,
+                 i;
+  guint          day;
+
+  /* 2010 in New York, as seen from UTC */
+  tz = g_time_zone_new ("America/New_York");
+  days = g_time_zone_days_new (tz, G_GINT64_CONSTANT (1262322000),
+                               G_GINT64_CONSTANT (1293857999));
+  g_assert_cmpuint (g_time_zone_days_get_n_days (days), ==, 365);
+  g_assert_cmpint (g_time_zone_days_get_start (days, 0), ==,
+                   G_GINT64_CONSTANT (1262322000));
+
+  /* March 14th is 23 hours long and November 7th 25 hours */
+  day = 31 + 28 + 13;
+  g_assert_cmpint (g_time_zone_days_get_start (days, day + 1) -
+                   g_time_zone_days_get_start (days, day), ==, 23 * 3600);
+  day = 304 + 6;
+  g_assert_cmpint (g_time_zone_days_get_start (days, day + 1) -
+                   g_time_zone_days_get_start (days, day), ==, 25 * 3600);
+
+  for (t = G_GINT64_CONSTANT (1262322000);
+       t < G_GINT64_CONSTANT (1293858000); t += 1800)
+    {
+      local = t + g_time_zone_get_offset (tz,
+                    g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, t));
+      g_assert_cmpint (g_time_zone_days_find (days, t), ==,
+                       local / 86400 - 14610);
+    }
+
+  g_assert_cmpint (g_time_zone_days_find (days, G_GINT64_CONSTANT (1262321999)), ==, -1);
+  g_assert_cmpint (g_time_zone_days_find (days, G_GINT64_CONSTANT (1293858000)), ==, -1);
+
+  /* Batches give the same days */
+  n_times = 10000;
+  times = g_new (gint64, n_times);
+  indices = g_new (gint, n_times);
+  for (i = 0; i < n_times; i++)
+    times [i] = G_GINT64_CONSTANT (1262300000) + (i * 7919 % n_times) * 3600;
+  g_time_zone_days_find_times (days, times, indices, n_times);
+  for (i = 0; i < n_times; i++)
+    g_assert_cmpint (indices [i], ==, g_time_zone_days_find (days, times [i]));
+  g_free (times);
+  g_free (indices);
+  g_time_zone_days_free (days);
+
+  /* Midnight was skipped in Sao Paulo on October 17th 2010 */
+  tz = g_time_zone_new ("America/Sao_Paulo");
+  days = g_time_zone_days_new (tz, G_GINT64_CONSTANT (1287198000),
+                               G_GINT64_CONSTANT (1287367199));
+  g_assert_cmpuint (g_time_zone_days_get_n_days (days), ==, 2);
+  g_assert_cmpint (g_time_zone_days_get_start (days, 1), ==,
+                   G_GINT64_CONSTANT (1287284400));
+  g_assert_cmpint (g_time_zone_days_get_start (days, 2), ==,
+                   G_GINT64_CONSTANT (1287367200));
+  g_time_zone_days_free (days);
+
+  /* December 30th 2011 never happened in Samoa */
+  tz = g_time_zone_new ("Pacific/Apia");
+  days = g_time_zone_days_new (tz, G_GINT64_CONSTANT (1325152800),
+                               G_GINT64_CONSTANT (1325239200));
+  g_assert_cmpuint (g_time_zone_days_get_n_days (days), ==, 3);
+  g_assert_cmpint (g_time_zone_days_get_start (days, 1), ==,
+                   g_time_zone_days_get_start (days, 2));
+  g_assert_cmpint (g_time_zone_days_find (days, G_GINT64_CONSTANT (1325239200)), ==, 2);
+  g_time_zone_days_free (days);
+
+  if (g_test_perf ())
+    {
+      tz = g_time_zone_new ("Europe/Berlin");
+      days = g_time_zone_days_new (tz, G_GINT64_CONSTANT (946684800),
+                                   G_GINT64_CONSTANT (1893456000));
+
+      n_times = 10000000;
+      times = g_new (gint64, n_times);
+      indices = g_new (gint, n_times);
+      for (i = 0; i < n_times; i++)
+        times [i] = G_GINT64_CONSTANT (946684800) + (i * 7919 % n_times) * 94;
+
+      timer = g_timer_new ();
+      g_time_zone_days_find_times (days, times, indices, n_times);
+      g_timer_stop (timer);
+      g_test_maximized_result (n_times / g_timer_elapsed (timer, NULL),
+                               "%.0f events per second",
+                               n_times / g_timer_elapsed (timer, NULL));
+      g_timer_destroy (timer);
+
+      g_free (times);
+      g_free (indices);
+      g_time_zone_days_free (days);
+    }
+}
+
+static void
+test_GTimeZone_find_interval (void)
+{
+  GTimeZone *tz;
+  gint64     t;
+  gint       i;
+
+  if (!(tz = g_time_zone_new ("America/New_York")))
+    return;
+
+  /* 2010-03-14 06:59:59 UTC is the last second of EST */
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, 1268549999);
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, -5 * 3600);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "EST");
+  g_assert (!g_time_zone_is_dst (tz, i));
+
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, 1268550000);
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, -4 * 3600);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "EDT");
+  g_assert (g_time_zone_is_dst (tz, i));
+
+  /* 02:30 local does not exist that day and resolves to EST */
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL, 1268533800);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "EST");
+
+  /* Sweep 2010 both ways so lookups hit and leave the cached interval */
+  for (t = 1262304000; t < 1293840000; t += 1800)
+    {
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, t);
+      g_assert_cmpint (g_time_zone_get_offset (tz, i), ==,
+                       (t >= 1268550000 && t < 1289109600) ? -4 * 3600
+                                                            : -5 * 3600);
+    }
+  for (t = 1293840000; t > 1262304000; t -= 1800)
+    {
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL, t);
+      g_assert_cmpint (g_time_zone_is_dst (tz, i), ==,
+                       t >= 1268550000 - 4 * 3600 &&
+                       t < 1289109600 - 5 * 3600);
+    }
+
+  g_time_zone_unref (tz);
+}
+
+static void
+test_GTimeZone_index (void)
+{
+  GDateTime *dt;
+  GTimeZone *tz,
+            *utc;
+  GTimeSpan  ts;
+  guint      index_;
+
+  if (!(tz = g_time_zone_new ("Europe/Berlin")))
+    return;
+
+  index_ = g_time_zone_get_index (tz);
+  g_assert_cmpuint (index_, !=, 0);
+  g_assert_cmpuint (g_time_zone_get_index (tz), ==, index_);
+  g_assert (g_time_zone_lookup_index (index_) == tz);
+
+  utc = g_time_zone_new_utc ();
+  g_assert_cmpuint (g_time_zone_get_index (utc), !=, index_);
+  g_assert (g_time_zone_lookup_index (g_time_zone_get_index (utc)) == utc);
+
+  /* Indices outlive a refresh, which keeps the unchanged zone */
+  dt = g_date_time_new_full_with_zone (tz, 2009, 7, 1, 12, 0, 0);
+  g_time_zone_refresh ();
+  g_assert (g_time_zone_new ("Europe/Berlin") == tz);
+  g_assert_cmpuint (g_time_zone_get_index (g_time_zone_new ("Europe/Berlin")),
+                    ==, index_);
+  g_assert (g_time_zone_lookup_index (index_) == tz);
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, 2 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (dt);
+
+  /* Indices not handed out yet are rejected rather than read as NULL */
+  index_ = g_time_zone_get_index (g_time_zone_new ("+03:07"));
+  if (g_test_trap_fork (0, G_TEST_TRAP_SILENCE_STDERR))
+    {
+      g_time_zone_lookup_index (index_ + 1);
+      exit (0);
+    }
+  g_test_trap_assert_failed ();
+}
+
+static void
+test_GTimeZone_resolve_local (void)
+{
+  GTimeZone *tz;
+  gint64     earlier,
+             later,
+             utc;
+
+  if (!(tz = g_time_zone_new ("America/New_York")))
+    return;
+
+  /* 2010-11-07 01:30 is repeated */
+  g_assert_cmpint (g_time_zone_find_instants (tz, 1289093400, &earlier, &later), ==, 2);
+  g_assert_cmpint (earlier, ==, 1289107800);
+  g_assert_cmpint (later, ==, 1289111400);
+
+  /* 2010-03-14 02:30 is skipped by the transition at 07:00 UTC */
+  g_assert_cmpint (g_time_zone_find_instants (tz, 1268533800, &earlier, &later), ==, 0);
+  g_assert_cmpint (earlier, ==, 1268550000);
+
+  g_assert (g_time_zone_resolve_local (tz, 1268533800, G_TIME_RESOLVE_EARLIER, &utc));
+  g_assert_cmpint (utc, ==, 1268548200);
+  g_assert (g_time_zone_resolve_local (tz, 1268533800, G_TIME_RESOLVE_LATER, &utc));
+  g_assert_cmpint (utc, ==, 1268551800);
+  g_assert (g_time_zone_resolve_local (tz, 1268533800, G_TIME_RESOLVE_SHIFT_FORWARD, &utc));
+  g_assert_cmpint (utc, ==, 1268550000);
+  g_assert (!g_time_zone_resolve_local (tz, 1268533800, G_TIME_RESOLVE_REJECT, &utc));
+
+  /* 2010-07-01 12:00 is unambiguous */
+  g_assert_cmpint (g_time_zone_find_instants (tz, 1277985600, &earlier, &later), ==, 1);
+  g_assert_cmpint (earlier, ==, 1277985600 + 4 * 3600);
+  g_assert (g_time_zone_resolve_local (tz, 1277985600, G_TIME_RESOLVE_REJECT, &utc));
+  g_assert_cmpint (utc, ==, earlier);
+
+  g_time_zone_unref (tz);
+}
+
+static gint32
+test_GTimeZone_libc_offset (gint64 t)
+{
+  GTimeZone *tz;
+  struct tm  tm;
+  time_t     tt = t;
+
+  /* Only compare with libc where it knows the offset */
+  tz = g_time_zone_new_local ();
+  localtime_r (&tt, &tm);
+  g_assert_cmpint (g_time_zone_get_offset (tz,
+                   g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, t)),
+                   ==, tm.tm_gmtoff);
+
+  return tm.tm_gmtoff;
+}
+
+static void
+test_GTimeZone_libc (void)
+{
+  gchar  *saved,
+         *filename;
+  GTimer *timer;
+  gint64  t,
+          lo,
+          hi,
+          mid;
+  gint32  offset,
+          prev;
+  gint    i;
+
+  /* Zones unknown to the zoneinfo database are probed from libc */
+  saved = g_strdup (g_getenv ("TZ"));
+  filename = g_build_filename (g_get_user_cache_dir (), "gtimezone",
+                               "Nowhere%2fLibc", NULL);
+  g_setenv ("TZ", "Nowhere/Libc", TRUE);
+  g_unlink (filename);
+  g_time_zone_refresh ();
+
+  /* Every change of offset is found to the second */
+  prev = test_GTimeZone_libc_offset (0);
+  for (t = 3600; t < G_GINT64_CONSTANT (2145916800); t += 3600)
+    {
+      if ((offset = test_GTimeZone_libc_offset (t)) == prev)
+        continue;
+
+      for (lo = t - 3600, hi = t; hi - lo > 1; )
+        {
+          mid = lo + (hi - lo) / 2;
+          if (test_GTimeZone_libc_offset (mid) == prev)
+            lo = mid;
+          else
+            hi = mid;
+        }
+
+      prev = offset;
+    }
+
+  if (g_test_perf ())
+    {
+      timer = g_timer_new ();
+
+      for (i = 0; i < 10; i++)
+        {
+          g_unlink (filename);
+          g_time_zone_refresh ();
+          g_time_zone_new_local ();
+        }
+
+      g_timer_stop (timer);
+      g_test_minimized_result (g_timer_elapsed (timer, NULL) / 10,
+                               "probing libc: %.6f seconds",
+                               g_timer_elapsed (timer, NULL) / 10);
+      g_timer_destroy (timer);
+    }
+
+  g_unlink (filename);
+  g_free (filename);
+
+  if (saved)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+  g_time_zone_refresh ();
+}
+
+static void
+test_GTimeZone_libc_short_append (GString *data,
+                                  guint32  value)
+{
+  g_string_append_c (data, (value >> 24) & 0xff);
+  g_string_append_c (data, (value >> 16) & 0xff);
+  g_string_append_c (data, (value >> 8) & 0xff);
+  g_string_append_c (data, value & 0xff);
+}
+
+static gint32
+test_GTimeZone_libc_short_offset (GTimeZone *tz,
+                                  gint64     t)
+{
+  return g_time_zone_get_offset (tz,
+           g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, t));
+}
+
+static void
+test_GTimeZone_libc_short (void)
+{
+  const gint64  t = 1000000000,
+                day = 86400;
+  const gint64  changes [] = { t, t + 10 * day, t + 12 * day,
+                               t + 17 * day + 3600, t + 17 * day + 7200,
+                               t + 112 * day + 3600, t + 114 * day };
+  GTimeZone    *tz;
+  GString      *data;
+  gchar        *saved,
+               *saved_tzdir,
+               *dir,
+               *source,
+               *filename;
+  guint         i;
+
+  /* A zoneinfo file whose abbreviations lack the final NUL is rejected by
+   * us but read by glibc, so the zone is probed from libc */
+  data = g_string_new ("TZif");
+  g_string_append_len (data, "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16);
+  test_GTimeZone_libc_short_append (data, 0);
+  test_GTimeZone_libc_short_append (data, 0);
+  test_GTimeZone_libc_short_append (data, 0);
+  test_GTimeZone_libc_short_append (data, G_N_ELEMENTS (changes));
+  test_GTimeZone_libc_short_append (data, 2);
+  test_GTimeZone_libc_short_append (data, 7);
+  for (i = 0; i < G_N_ELEMENTS (changes); i++)
+    test_GTimeZone_libc_short_append (data, changes [i]);
+  for (i = 0; i < G_N_ELEMENTS (changes); i++)
+    g_string_append_c (data, i % 2 == 0);
+  g_string_append_len (data, "\0\0\0\0\0\0", 6);
+  g_string_append_len (data, "\0\0\016\020\001\004", 6);
+  g_string_append_len (data, "XST\0XDT", 7);
+
+  saved = g_strdup (g_getenv ("TZ"));
+  saved_tzdir = g_strdup (g_getenv ("TZDIR"));
+  dir = g_build_filename (g_get_tmp_dir (), "gtimezone-XXXXXX", NULL);
+  g_assert (mkdtemp (dir) != NULL);
+  source = g_build_filename (dir, "Short", NULL);
+  filename = g_build_filename (g_get_user_cache_dir (), "gtimezone", "Short",
+                               NULL);
+  g_assert (g_file_set_contents (source, data->str, data->len, NULL));
+  g_string_free (data, TRUE);
+  g_setenv ("TZDIR", dir, TRUE);
+  g_setenv ("TZ", "Short", TRUE);
+  g_unlink (filename);
+  g_time_zone_refresh ();
+  tz = g_time_zone_new_local ();
+
+  /* Changes found by the weekly samples are found to the second */
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz, t - 1), ==, 0);
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz, t), ==, 3600);
+
+  /* Daily samples after a change find a suspension two days long */
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz, t + 10 * day - 1),
+                   ==, 3600);
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz, t + 10 * day),
+                   ==, 0);
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz, t + 12 * day),
+                   ==, 3600);
+
+  /* An hour long suspension between daily samples is missed */
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz,
+                   t + 17 * day + 5400), ==, 3600);
+
+  /* And so is a two day suspension between weekly samples, four weeks
+   * after the last change */
+  g_assert_cmpint (test_GTimeZone_libc_short_offset (tz, t + 113 * day),
+                   ==, 3600);
+
+  g_time_zone_unref (tz);
+
+  g_unlink (filename);
+  g_unlink (source);
+  g_rmdir (dir);
+  g_free (filename);
+  g_free (source);
+  g_free (dir);
+
+  if (saved_tzdir)
+    g_setenv ("TZDIR", saved_tzdir, TRUE);
+  else
+    g_unsetenv ("TZDIR");
+  g_free (saved_tzdir);
+
+  if (saved)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+  g_time_zone_refresh ();
+}
+
+static void
+test_GTimeZone_new (void)
+{
+  GTimeZone *tz, *tz2;
+
+  if (!(tz = g_time_zone_new ("Europe/Berlin")))
+    return;
+
+  g_assert_cmpstr (g_time_zone_get_identifier (tz), ==, "Europe/Berlin");
+
+  /* Zones are only loaded once */
+  tz2 = g_time_zone_new ("Europe/Berlin");
+  g_assert (tz == tz2);
+  g_time_zone_unref (tz2);
+  g_time_zone_unref (tz);
+
+  g_assert (g_time_zone_new ("No/Such_Zone") == NULL);
+}
+
+static void
+test_GTimeZone_new_fixed (void)
+{
+  GTimeZone *tz;
+
+  tz = g_time_zone_new ("+05:30");
+  g_assert (tz != NULL);
+  g_assert_cmpint (g_time_zone_get_offset (tz, 0), ==, 19800);
+  g_time_zone_unref (tz);
+
+  tz = g_time_zone_new ("-0800");
+  g_assert (tz != NULL);
+  g_assert_cmpint (g_time_zone_get_offset (tz, 0), ==, -28800);
+  g_time_zone_unref (tz);
+
+  tz = g_time_zone_new_utc ();
+  g_assert_cmpint (g_time_zone_get_offset (tz, 0), ==, 0);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, 0), ==, "UTC");
+  g_time_zone_unref (tz);
+}
+
+static void
+test_GTimeZone_registry (void)
+{
+  GTimeZone *zones [96];
+  gchar      identifier [8];
+  gint       i;
+
+  /* Enough fixed offsets to make the registry grow a few times */
+  for (i = 0; i < G_N_ELEMENTS (zones); i++)
+    {
+      g_snprintf (identifier, sizeof (identifier), "+%02d:%02d",
+                  i / 4, (i % 4) * 15);
+      zones [i] = g_time_zone_new (identifier);
+      g_assert_cmpint (g_time_zone_get_offset (zones [i], 0), ==, i * 900);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (zones); i++)
+    {
+      g_snprintf (identifier, sizeof (identifier), "+%02d:%02d",
+                  i / 4, (i % 4) * 15);
+      g_assert (g_time_zone_new (identifier) == zones [i]);
+    }
+}
+
+static void
+test_GTimeZone_refresh (void)
+{
+  GTimeZone *tz1,
+            *tz2,
+            *local;
+  gchar     *saved;
+  guint      n_zones1,
+             n_zones2;
+  gsize      n_bytes1,
+             n_bytes2;
+  gint       i;
+
+  /* Zones whose rules did not change are kept rather than leaked */
+  tz1 = g_time_zone_new ("Europe/Berlin");
+  local = g_time_zone_new_local ();
+  g_time_zone_get_tai_offset (0);
+  g_time_zone_get_cache_stats (&n_zones1, NULL, &n_bytes1);
+  for (i = 0; i < 3; i++)
+    {
+      g_time_zone_refresh ();
+      tz2 = g_time_zone_new ("Europe/Berlin");
+      g_assert (tz2 == tz1);
+      g_assert (g_time_zone_new_local () == local);
+      g_time_zone_get_tai_offset (0);
+    }
+  g_time_zone_get_cache_stats (&n_zones2, NULL, &n_bytes2);
+  g_assert_cmpuint (n_zones2, ==, n_zones1);
+  g_assert_cmpuint (n_bytes2, ==, n_bytes1);
+
+  /* Zones retrieved before the refresh remain usable */
+  i = g_time_zone_find_interval (tz1, G_TIME_TYPE_UNIVERSAL, 0);
+  g_assert_cmpint (g_time_zone_get_offset (tz1, i), ==, 3600);
+
+  /* A new $TZ takes effect once refreshed */
+  saved = g_strdup (g_getenv ("TZ"));
+  g_setenv ("TZ", "<-03>3", TRUE);
+  g_time_zone_refresh ();
+  tz1 = g_time_zone_new_local ();
+  i = g_time_zone_find_interval (tz1, G_TIME_TYPE_UNIVERSAL, 0);
+  g_assert_cmpint (g_time_zone_get_offset (tz1, i), ==, -10800);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz1, i), ==, "-03");
+
+  if (saved)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+  g_time_zone_refresh ();
+  g_assert (g_time_zone_new_local () != tz1);
+}
+
+static void
+test_GTimeZone_rule (void)
+{
+  GTimeZone *tz;
+  gint64     t;
+  gint       i;
+
+  tz = g_time_zone_new ("CET-1CEST,M3.5.0,M10.5.0/3");
+  g_assert (tz != NULL);
+
+  /* Daylight savings starts at 2100-03-28 01:00:00 UTC */
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                 G_GINT64_CONSTANT (4109878799));
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 3600);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "CET");
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                 G_GINT64_CONSTANT (4109878800));
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 7200);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "CEST");
+  g_assert (g_time_zone_is_dst (tz, i));
+
+  /* 02:30 is skipped on 2100-03-28 and repeated on 2100-10-31 */
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL,
+                                 G_GINT64_CONSTANT (4109884200));
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "CET");
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL,
+                                 G_GINT64_CONSTANT (4128633000));
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "CET");
+
+  for (t = G_GINT64_CONSTANT (4102444800);
+       t < G_GINT64_CONSTANT (4133980800);
+       t += 1800)
+    {
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, t);
+      g_assert_cmpint (g_time_zone_is_dst (tz, i), ==,
+                       t >= G_GINT64_CONSTANT (4109878800) &&
+                       t < G_GINT64_CONSTANT (4128627600));
+    }
+  g_time_zone_unref (tz);
+
+  /* Southern hemisphere, daylight savings spans the new year */
+  tz = g_time_zone_new ("AEST-10AEDT,M10.1.0,M4.1.0/3");
+  g_assert (tz != NULL);
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL,
+                                 G_GINT64_CONSTANT (10415044800));
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 39600);
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL,
+                                 G_GINT64_CONSTANT (10428091200));
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 36000);
+  g_time_zone_unref (tz);
+
+  tz = g_time_zone_new ("<+0330>-3:30");
+  g_assert (tz != NULL);
+  g_assert_cmpint (g_time_zone_get_offset (tz, 0), ==, 12600);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, 0), ==, "+0330");
+  g_time_zone_unref (tz);
+
+  g_assert (g_time_zone_new ("CET-1CEST,M13.5.0,M10.5.0") == NULL);
+
+  /* Zoneinfo files fall back to their footer after the last transition */
+  if ((tz = g_time_zone_new ("Europe/Berlin")))
+    {
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                     G_GINT64_CONSTANT (4118083200));
+      g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 7200);
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                     G_GINT64_CONSTANT (4131302400));
+      g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 3600);
+    }
+}
+
+#ifdef HAVE_MMAP
+/*
+ * Checks whether @address lies within a read-only mapping whose pages are
+ * also mapped by another process, according to /proc/self/smaps.
+ */
+static gboolean
+test_GTimeZone_share_is_shared (gconstpointer address)
+{
+  gchar    *contents,
+          **lines,
+            perms [5];
+  gulong    start,
+            end,
+            rss = 0,
+            pss = 0;
+  gboolean  found = FALSE,
+            within = FALSE;
+  gint      i;
+
+  g_assert (g_file_get_contents ("/proc/self/smaps", &contents, NULL, NULL));
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (i = 0; lines [i]; i++)
+    {
+      if (sscanf (lines [i], "%lx-%lx %4s", &start, &end, perms) == 3)
+        {
+          within = start <= (gulong)address && (gulong)address < end;
+          if (within)
+            found = strcmp (perms, "r--s") == 0;
+        }
+      else if (within)
+        {
+          sscanf (lines [i], "Rss: %lu kB", &rss);
+          sscanf (lines [i], "Pss: %lu kB", &pss);
+        }
+    }
+
+  g_strfreev (lines);
+
+  /* Pages mapped by several processes count towards Pss in part only */
+  return found && pss < rss;
+}
+#endif
+
+static void
+test_GTimeZone_share (void)
+{
+  const gchar *identifiers [] = { "Europe/Berlin", "America/New_York", NULL };
+  GTimeZone   *berlin,
+              *local,
+              *tz;
+  guint        n_zones,
+               n,
+               index_;
+  gsize        n_bytes1,
+               n_bytes2;
+  gint         i;
+
+  g_time_zone_refresh ();
+  tz = g_time_zone_new ("Europe/Berlin");
+  index_ = g_time_zone_get_index (tz);
+
+  /* The copies are not counted on top of the zones they were made from */
+  for (i = 0; identifiers [i]; i++)
+    g_time_zone_new (identifiers [i]);
+  g_time_zone_new_utc ();
+  g_time_zone_new_local ();
+  g_time_zone_get_cache_stats (NULL, NULL, &n_bytes1);
+  g_time_zone_share (identifiers);
+  g_time_zone_get_cache_stats (NULL, NULL, &n_bytes2);
+  g_assert_cmpuint (n_bytes2, ==, n_bytes1);
+
+  /* Shared zones are copies and describe the same rules */
+  berlin = g_time_zone_new ("Europe/Berlin");
+#ifdef HAVE_MMAP
+  g_assert (berlin != tz);
+#endif
+  g_assert (g_time_zone_new ("Europe/Berlin") == berlin);
+  g_assert_cmpuint (g_time_zone_get_index (berlin), ==, index_);
+  g_assert (g_time_zone_lookup_index (index_) == berlin);
+  g_assert_cmpstr (g_time_zone_get_identifier (berlin), ==, "Europe/Berlin");
+  i = g_time_zone_find_interval (berlin, G_TIME_TYPE_UNIVERSAL,
+                                 G_GINT64_CONSTANT (1277942400));
+  g_assert_cmpint (g_time_zone_get_offset (berlin, i), ==, 7200);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (berlin, i), ==, "CEST");
+  i = g_time_zone_find_interval (berlin, G_TIME_TYPE_UNIVERSAL,
+                                 G_GINT64_CONSTANT (4102444800));
+  g_assert_cmpint (g_time_zone_get_offset (berlin, i), ==, 3600);
+  g_assert_cmpint (g_time_zone_get_tai_offset (1483228800), ==, 37);
+
+  g_time_zone_ref (berlin);
+  g_time_zone_unref (berlin);
+
+  local = g_time_zone_new_local ();
+  g_assert (g_time_zone_new_local () == local);
+
+  /* Children find the shared zones without loading anything */
+  g_time_zone_get_cache_stats (&n_zones, NULL, NULL);
+  if (g_test_trap_fork (0, 0))
+    {
+      g_assert (g_time_zone_new ("Europe/Berlin") == berlin);
+      g_assert (g_time_zone_new_local () == local);
+      g_assert_cmpuint (g_time_zone_get_index (berlin), !=, 0);
+      tz = g_time_zone_new ("America/New_York");
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, 0);
+      g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, -18000);
+      g_time_zone_get_cache_stats (&n, NULL, NULL);
+      g_assert_cmpuint (n, ==, n_zones);
+
+#ifdef HAVE_MMAP
+      /* The child reads the very pages the parent wrote */
+      if (g_file_test ("/proc/self/smaps", G_FILE_TEST_EXISTS))
+        {
+          g_assert (test_GTimeZone_share_is_shared (berlin));
+          g_assert (test_GTimeZone_share_is_shared (local));
+          g_assert (test_GTimeZone_share_is_shared (
+                      g_time_zone_lookup_index (index_)));
+        }
+#endif
+
+      /* Zones loaded later are registered privately */
+      tz = g_time_zone_new ("Asia/Tokyo");
+      g_assert (tz != NULL);
+      g_assert (g_time_zone_new ("Asia/Tokyo") == tz);
+      g_assert (g_time_zone_new ("Europe/Berlin") == berlin);
+      exit (0);
+    }
+  g_test_trap_assert_passed ();
+
+  g_time_zone_refresh ();
+}
+
+static void
+test_GTimeZone_tai_offset (void)
+{
+  gint64 t;
+
+  g_assert_cmpint (g_time_zone_get_tai_offset (G_GINT64_CONSTANT (-1000000000)), ==, 10);
+  g_assert_cmpint (g_time_zone_get_tai_offset (0), ==, 10);
+  g_assert_cmpint (g_time_zone_get_tai_offset (78796799), ==, 10);
+  g_assert_cmpint (g_time_zone_get_tai_offset (78796800), ==, 11);
+  g_assert_cmpint (g_time_zone_get_tai_offset (315964800), ==, 19);
+  g_assert_cmpint (g_time_zone_get_tai_offset (1483228799), ==, 36);
+  g_assert_cmpint (g_time_zone_get_tai_offset (1483228800), ==, 37);
+  g_assert_cmpint (g_time_zone_get_tai_offset (G_GINT64_CONSTANT (4102444800)), ==, 37);
+
+  /* The offset never falls and grows by at most a second a day */
+  for (t = 0; t < G_GINT64_CONSTANT (1600000000); t += 86400)
+    g_assert_cmpint (g_time_zone_get_tai_offset (t + 86400) -
+                     g_time_zone_get_tai_offset (t), <=, 1);
+}
+
+static gpointer
+test_GTimeZone_thread_default_func (gpointer data)
+{
+  GDateTime *dt;
+  GTimeSpan  ts;
+
+  /* Zones pushed by other threads do not apply here */
+  g_assert (g_time_zone_get_thread_default () == NULL);
+
+  g_time_zone_push_thread_default (data);
+  dt = g_date_time_new_full (2010, 7, 1, 12, 0, 0);
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, -4 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (dt);
+  g_time_zone_pop_thread_default (data);
+
+  return NULL;
+}
+
+static void
+test_GTimeZone_thread_default (void)
+{
+  GTimeZone *tokyo,
+            *new_york;
+  GDateTime *dt,
+            *local;
+  GThread   *thread;
+  GTimeSpan  ts;
+  gchar     *str;
+
+  tokyo = g_time_zone_new ("Asia/Tokyo");
+  new_york = g_time_zone_new ("America/New_York");
+
+  g_assert (g_time_zone_get_thread_default () == NULL);
+  g_time_zone_push_thread_default (tokyo);
+  g_assert (g_time_zone_get_thread_default () == tokyo);
+
+  dt = g_date_time_now ();
+  g_date_time_get_utc_offset (dt, &ts);
+  g_assert_cmpint (ts, ==, 9 * G_TIME_SPAN_HOUR);
+  g_date_time_unref (dt);
+
+  thread = g_thread_create (test_GTimeZone_thread_default_func,
+                            new_york, TRUE, NULL);
+  g_thread_join (thread);
+
+  /* Zones nest, and the innermost applies */
+  g_time_zone_push_thread_default (new_york);
+  dt = g_date_time_new_full (2010, 1, 1, 12, 0, 0);
+  local = g_date_time_to_local (dt);
+  g_assert_cmpint (g_date_time_get_hour (local), ==, 12);
+  g_date_time_unref (local);
+  g_time_zone_pop_thread_default (new_york);
+  g_assert (g_time_zone_get_thread_default () == tokyo);
+
+  /* Wall clock times keep the zone after it is popped */
+  str = g_date_time_printf (dt, "%H:%M %z");
+  g_assert_cmpstr (str, ==, "12:00 EST");
+  g_free (str);
+
+  local = g_date_time_to_local (dt);
+  g_assert_cmpint (g_date_time_get_hour (local), ==, 2);
+  g_assert_cmpint (g_date_time_get_day_of_month (local), ==, 2);
+  str = g_date_time_printf (local, "%z");
+  g_assert_cmpstr (str, ==, "JST");
+  g_free (str);
+  g_date_time_unref (local);
+  g_date_time_unref (dt);
+
+  g_time_zone_pop_thread_default (tokyo);
+  g_assert (g_time_zone_get_thread_default () == NULL);
+
+  /* Without a pushed zone the zone of the process applies again */
+  dt = g_date_time_new_from_date (2010, 1, 1);
+  local = g_date_time_new_full_with_zone (g_time_zone_new_local (),
+                                          2010, 1, 1, 0, 0, 0);
+  g_assert (g_date_time_equal (dt, local));
+  g_date_time_unref (local);
+  g_date_time_unref (dt);
+}
+
+#define N_LOOKUPS 200000
+
+static gpointer
+test_GTimeZone_threads_func (gpointer data)
+{
+  GDateTime *dt;
+  GTimeZone *tz;
+  gint       i;
+
+  for (i = 0; i < N_LOOKUPS; i++)
+    {
+      tz = g_time_zone_new ("UTC");
+      dt = g_date_time_new_full (2009, 12, 11, 12, 11, 10);
+      g_date_time_unref (dt);
+      g_time_zone_unref (tz);
+    }
+
+  return NULL;
+}
+
+static void
+test_GTimeZone_threads (void)
+{
+  GThread *threads [32];
+  GTimer  *timer;
+  gdouble  elapsed;
+  gint     n_threads,
+           i;
+
+  if (!g_test_perf ())
+    return;
+
+  timer = g_timer_new ();
+
+  /* Each thread does the same work, so ideal scaling keeps this flat */
+  for (n_threads = 1; n_threads <= G_N_ELEMENTS (threads); n_threads *= 2)
+    {
+      g_timer_start (timer);
+
+      for (i = 0; i < n_threads; i++)
+        threads [i] = g_thread_create (test_GTimeZone_threads_func,
+                                       NULL, TRUE, NULL);
+      for (i = 0; i < n_threads; i++)
+        g_thread_join (threads [i]);
+
+      g_timer_stop (timer);
+      elapsed = g_timer_elapsed (timer, NULL);
+      g_test_minimized_result (elapsed,
+                               "%d threads, %d lookups each: %.3f seconds",
+                               n_threads, N_LOOKUPS, elapsed);
+    }
+
+  g_timer_destroy (timer);
+}
+
+static void
+test_GTimeZone_watch (void)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+  GTimeZone *tz;
+  gchar     *saved,
+            *dir,
+            *source,
+            *filename,
+            *contents;
+  gsize      length;
+  gint       i,
+             tries;
+
+  saved = g_strdup (g_getenv ("TZDIR"));
+  dir = g_build_filename (g_get_tmp_dir (), "gtimezone-XXXXXX", NULL);
+  g_assert (mkdtemp (dir) != NULL);
+  filename = g_build_filename (dir, "Test", NULL);
+
+  source = g_build_filename (saved ? saved : "/usr/share/zoneinfo",
+                             "Europe/Berlin", NULL);
+  g_assert (g_file_get_contents (source, &contents, &length, NULL));
+  g_assert (g_file_set_contents (filename, contents, length, NULL));
+  g_free (contents);
+  g_free (source);
+
+  g_setenv ("TZDIR", dir, TRUE);
+  g_time_zone_refresh ();
+  tz = g_time_zone_new ("Test");
+  g_assert (tz != NULL);
+  i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                 G_GINT64_CONSTANT (1262304000));
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 3600);
+
+  /* Zones loaded before the watch starts are watched too */
+  g_assert (g_time_zone_watch_start ());
+  g_assert (g_time_zone_watch_start ());
+  g_assert (g_time_zone_new ("Test") == tz);
+
+  /* Children do not inherit the watch, but can start their own */
+  if (g_test_trap_fork (0, 0))
+    {
+      g_time_zone_refresh ();
+      g_assert (g_time_zone_new ("Test") != NULL);
+      g_assert (g_time_zone_watch_start ());
+      exit (0);
+    }
+  g_test_trap_assert_passed ();
+
+  /* Rewriting the file is noticed without calling g_time_zone_refresh() */
+  source = g_build_filename (saved ? saved : "/usr/share/zoneinfo",
+                             "Asia/Tokyo", NULL);
+  g_assert (g_file_get_contents (source, &contents, &length, NULL));
+  g_assert (g_file_set_contents (filename, contents, length, NULL));
+  g_free (contents);
+  g_free (source);
+
+  for (tries = 0; tries < 100; tries++)
+    {
+      tz = g_time_zone_new ("Test");
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                     G_GINT64_CONSTANT (1262304000));
+      if (g_time_zone_get_offset (tz, i) != 3600)
+        break;
+      g_usleep (G_USEC_PER_SEC / 20);
+    }
+  g_assert_cmpint (g_time_zone_get_offset (tz, i), ==, 32400);
+  g_assert_cmpstr (g_time_zone_get_abbreviation (tz, i), ==, "JST");
+
+  g_unlink (filename);
+  g_rmdir (dir);
+  g_free (filename);
+  g_free (dir);
+
+  if (saved)
+    g_setenv ("TZDIR", saved, TRUE);
+  else
+    g_unsetenv ("TZDIR");
+  g_free (saved);
+  g_time_zone_refresh ();
+#else
+  g_assert (!g_time_zone_watch_start ());
+#endif
 }
 
 static void
@@ -1224,6 +3266,23 @@ gint
 main (gint   argc,
       gchar *argv[])
 {
+  const gchar *name;
+  gchar       *cache_dir,
+              *dirname,
+              *filename;
+  GDir        *dir;
+  gint         result;
+
+  if (!g_thread_supported ())
+    g_thread_init (NULL);
+
+  /* Zones probed from libc are cached on disk, so keep them out of the
+   * user's own cache directory */
+  cache_dir = g_build_filename (g_get_tmp_dir (), "gdatetime-tests-XXXXXX",
+                                NULL);
+  g_assert (mkdtemp (cache_dir) != NULL);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
   g_type_init ();
   g_test_init (&argc, &argv, NULL);
 
@@ -1247,6 +3306,10 @@ main (gint   argc,
                    test_GDateTime_add_weeks);
   g_test_add_func ("/GDateTime/add_years",
                    test_GDateTime_add_years);
+  g_test_add_func ("/GDateTime/allocator",
+                   test_GDateTime_allocator);
+  g_test_add_func ("/GDateTime/arena",
+                   test_GDateTime_arena);
   g_test_add_func ("/GDateTime/compare",
                    test_GDateTime_compare);
   g_test_add_func ("/GDateTime/copy",
@@ -1283,12 +3346,20 @@ main (gint   argc,
                    test_GDateTime_get_second);
   g_test_add_func ("/GDateTime/get_utc_offset",
                    test_GDateTime_get_utc_offset);
+  g_test_add_func ("/GDateTime/get_utc_offset_historic",
+                   test_GDateTime_get_utc_offset_historic);
   g_test_add_func ("/GDateTime/get_year",
                    test_GDateTime_get_year);
   g_test_add_func ("/GDateTime/hash",
                    test_GDateTime_hash);
+  g_test_add_func ("/GDateTime/is_daylight_savings",
+                   test_GDateTime_is_daylight_savings);
   g_test_add_func ("/GDateTime/is_leap_year",
                    test_GDateTime_is_leap_year);
+  g_test_add_func ("/GDateTime/leap_seconds",
+                   test_GDateTime_leap_seconds);
+  g_test_add_func ("/GDateTime/local_zone",
+                   test_GDateTime_local_zone);
   g_test_add_func ("/GDateTime/new_from_date",
                    test_GDateTime_new_from_date);
   g_test_add_func ("/GDateTime/new_from_time_t",
@@ -1297,6 +3368,10 @@ main (gint   argc,
                    test_GDateTime_new_from_timeval);
   g_test_add_func ("/GDateTime/new_full",
                    test_GDateTime_new_full);
+  g_test_add_func ("/GDateTime/new_full_with_resolve",
+                   test_GDateTime_new_full_with_resolve);
+  g_test_add_func ("/GDateTime/new_full_with_zone",
+                   test_GDateTime_new_full_with_zone);
   g_test_add_func ("/GDateTime/now",
                    test_GDateTime_now);
   /*
@@ -1317,12 +3392,61 @@ main (gint   argc,
                    test_GDateTime_to_timeval);
   g_test_add_func ("/GDateTime/to_utc",
                    test_GDateTime_to_utc);
+  g_test_add_func ("/GDateTime/to_zone",
+                   test_GDateTime_to_zone);
   g_test_add_func ("/GDateTime/today",
                    test_GDateTime_today);
   g_test_add_func ("/GDateTime/unref",
                    test_GDateTime_unref);
   g_test_add_func ("/GDateTime/utc_now",
                    test_GDateTime_utc_now);
+  g_test_add_func ("/GDateTime/value",
+                   test_GDateTime_value);
+  g_test_add_func ("/GDateTime/warm_up",
+                   test_GDateTime_warm_up);
+
+  /* GTimeZone Tests */
+
+  g_test_add_func ("/GTimeZone/builtin",
+                   test_GTimeZone_builtin);
+  g_test_add_func ("/GTimeZone/cache_file",
+                   test_GTimeZone_cache_file);
+  g_test_add_func ("/GTimeZone/cache_stats",
+                   test_GTimeZone_cache_stats);
+  g_test_add_func ("/GTimeZone/convert_times",
+                   test_GTimeZone_convert_times);
+  g_test_add_func ("/GTimeZone/days",
+                   test_GTimeZone_days);
+  g_test_add_func ("/GTimeZone/find_interval",
+                   test_GTimeZone_find_interval);
+  g_test_add_func ("/GTimeZone/index",
+                   test_GTimeZone_index);
+  g_test_add_func ("/GTimeZone/libc",
+                   test_GTimeZone_libc);
+  g_test_add_func ("/GTimeZone/libc_short",
+                   test_GTimeZone_libc_short);
+  g_test_add_func ("/GTimeZone/new",
+                   test_GTimeZone_new);
+  g_test_add_func ("/GTimeZone/new_fixed",
+                   test_GTimeZone_new_fixed);
+  g_test_add_func ("/GTimeZone/refresh",
+                   test_GTimeZone_refresh);
+  g_test_add_func ("/GTimeZone/registry",
+                   test_GTimeZone_registry);
+  g_test_add_func ("/GTimeZone/resolve_local",
+                   test_GTimeZone_resolve_local);
+  g_test_add_func ("/GTimeZone/rule",
+                   test_GTimeZone_rule);
+  g_test_add_func ("/GTimeZone/share",
+                   test_GTimeZone_share);
+  g_test_add_func ("/GTimeZone/tai_offset",
+                   test_GTimeZone_tai_offset);
+  g_test_add_func ("/GTimeZone/thread_default",
+                   test_GTimeZone_thread_default);
+  g_test_add_func ("/GTimeZone/threads",
+                   test_GTimeZone_threads);
+  g_test_add_func ("/GTimeZone/watch",
+                   test_GTimeZone_watch);
 
   /* GCalendar Tests */
 
@@ -1365,5 +3489,23 @@ main (gint   argc,
   g_test_add_func ("/GCalendarJulian/is_leap_year",
                    test_GCalendarJulian_is_leap_year);
 
-  return g_test_run ();
+  result = g_test_run ();
+
+  dirname = g_build_filename (cache_dir, "gtimezone", NULL);
+  if ((dir = g_dir_open (dirname, 0, NULL)))
+    {
+      while ((name = g_dir_read_name (dir)))
+        {
+          filename = g_build_filename (dirname, name, NULL);
+          g_unlink (filename);
+          g_free (filename);
+        }
+      g_dir_close (dir);
+    }
+  g_rmdir (dirname);
+  g_rmdir (cache_dir);
+  g_free (dirname);
+  g_free (cache_dir);
+
+  return result;
 }
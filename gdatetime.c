@@ -43,6 +43,7 @@
 #include <unistd.h>
 
 #include "gdatetime.h"
+#include "gtimezone.h"
 
 /**
  * SECTION:g-date-time
@@ -56,9 +57,26 @@
  * #GDateTime is reference counted and should be freed using
  * g_date_time_unref().
  *
- * Internally, #GDateTime uses the Julian Day Number since the
- * initial Julian Period (-4712 BC).  However, the public API uses the
- * internationally accepted Gregorian Calendar.
+ * Where allocating a #GDateTime for every step is too costly, a
+ * #GDateTimeValue can be used instead.  It is held by value, such as on the
+ * stack, and has its own g_date_time_value_*() functions which never touch
+ * the heap.  Where many are created and released together, a
+ * #GDateTimeArena avoids freeing them one at a time.
+ *
+ * Internally, #GDateTime counts the microseconds of UTC since the start of
+ * the initial Julian Period (-4712 BC) in a single 64-bit integer, so that
+ * comparing and subtracting instants are single operations whatever their
+ * timezones.  Wall clock fields are worked out from the offset of the zone.
+ * However, the public API uses the internationally accepted Gregorian
+ * Calendar.
+ *
+ * A #GDateTime in the local timezone of the process, rather than one pushed
+ * with g_time_zone_push_thread_default(), keeps its instant but looks the
+ * local zone up whenever it needs a wall clock field.  When
+ * g_time_zone_refresh() picks up another local zone, such as after $TZ or
+ * /etc/localtime changed, it shows the same instant in the new zone.  This
+ * holds whether it was made from an instant, such as by g_date_time_now(),
+ * or from a wall clock time, such as by g_date_time_new_full().
  *
  * Conversion to other calendars can be done using the #GObject based
  * #GCalendar.
@@ -67,41 +85,19 @@
  */
 
 #define GREGORIAN_LEAP(y)    (((y%4)==0)&&(!(((y%100)==0)&&((y%400)!=0))))
-#define JULIAN_YEAR(d)       ((d)->julian/365.25)
 #define DAYS_PER_PERIOD      (2914695)
 #define USEC_PER_SECOND      (G_GINT64_CONSTANT (1000000))
 #define USEC_PER_MINUTE      (G_GINT64_CONSTANT (60000000))
 #define USEC_PER_HOUR        (G_GINT64_CONSTANT (3600000000))
 #define USEC_PER_MILLISECOND (G_GINT64_CONSTANT (1000))
 #define USEC_PER_DAY         (G_GINT64_CONSTANT (86400000000))
-#define ADD_DAYS(d,n) G_STMT_START {                                        \
-  gint __day = d->julian + (n);                                             \
-  if (__day < 1)                                                            \
-    {                                                                       \
-      d->period += -1 + (__day / DAYS_PER_PERIOD);                          \
-      d->period += DAYS_PER_PERIOD + (__day % DAYS_PER_PERIOD);             \
-    }                                                                       \
-  else if (__day > DAYS_PER_PERIOD)                                         \
-    {                                                                       \
-      d->period += (d->julian + (n)) / DAYS_PER_PERIOD;                     \
-      d->julian = (d->julian + (n)) % DAYS_PER_PERIOD;                      \
-    }                                                                       \
-  else                                                                      \
-    d->julian += n;                                                         \
-} G_STMT_END
+#define SEC_PER_DAY          (G_GINT64_CONSTANT (86400))
+#define UNIX_EPOCH_JULIAN    (2440588)
+#define GPS_EPOCH_TAI        (G_GINT64_CONSTANT (315964819))
+#define UNIX_EPOCH_USEC      (UNIX_EPOCH_JULIAN * USEC_PER_DAY)
 #define ADD_USEC(d,n) G_STMT_START {                                        \
-  gint64 __usec;                                                            \
-  gint   __days;                                                            \
-  __usec = (d)->usec + (n);                                                 \
-  __days = __usec / USEC_PER_DAY;                                           \
-  if (__usec < 0)                                                           \
-    __days -= 1;                                                            \
-  if (__days != 0)                                                          \
-    ADD_DAYS ((d), __days);                                                 \
-  if (__usec < 0)                                                           \
-    d->usec = USEC_PER_DAY + (__usec % USEC_PER_DAY);                       \
-  else                                                                      \
-    d->usec = __usec % USEC_PER_DAY;                                        \
+  (d)->usec += (n);                                                         \
+  (d)->leap = FALSE;                                                        \
 } G_STMT_END
 #define TO_JULIAN(year,month,day,julian) G_STMT_START {                     \
   gint a = (14 - month) / 12;                                               \
@@ -125,8 +121,6 @@
 #define GET_PREFERRED_DATE(d) (g_date_time_printf ((d), Q_("GDateTime|%m/%d/%y")))
 #define GET_PREFERRED_TIME(d) (g_date_time_printf ((d), Q_("GDateTime|%H:%M:%S")))
 
-typedef struct _GTimeZone GTimeZone;
-
 static const guint16 days_in_months[2][13] =
 {
   { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },
@@ -195,218 +189,231 @@ static const gchar* months_full[] = {
 
 struct _GDateTime
 {
-  gint           period   :  3; /* Julian Period, 0 is Initial Epoch */
-  guint          julian   : 22; /* Day within Julian Period */
-  guint64        usec     : 37; /* Microsecond timekeeping within Day */
-  gint           reserved :  2;
+  gint64         usec;          /* UTC time since the Initial Epoch */
 
   volatile gint  ref_count;
 
-  GTimeZone     *tz;            /* TimeZone information, NULL is UTC */
+  guint          local    :  1; /* In the local zone, looked up when needed */
+  guint          leap     :  1; /* A leap second, stored as the second after */
+  guint          arena    :  1; /* Within a #GDateTimeArena, not counted */
+  guint          zone     : 29; /* From g_time_zone_get_index(), 0 is UTC */
 };
 
-struct _GTimeZone
+/*
+ * A timezone abbreviation understood by %Z in
+ * g_date_time_parse_with_format(), within the perfect hash table written by
+ * gtzabbrs-gen.
+ */
+typedef struct
 {
-  gint    year;                 /* Gregorian Year */
-  gchar  *std_name;             /* Standard time abbreviation (PST) */
-  gint    std_gmtoff;           /* Standard offset seconds from UTC */
-  gchar  *dst_name;             /* Daylight savings abbreviation (PDT) */
-  gint    dst_gmtoff;           /* Daylight savings offset seconds from UTC */
+  const gchar *abbr;
+  gint32       offset;          /* Seconds east of UTC */
+} GTzAbbr;
+
+#include "gtzabbrs.h"
+
+/*
+ * Each #GDateTime is recycled through per-thread magazines rather than
+ * going to the slice allocator.  A thread allocates from and frees to its
+ * loaded magazine, swapping in its previous one when the loaded one runs
+ * empty or full.  Only when both are exhausted does it visit the depot, under
+ * a lock, to trade a whole magazine at once.  Objects freed by a thread other
+ * than the one which allocated them return this way too, a magazine at a
+ * time.  Objects are carved out in blocks of MAGAZINE_SIZE and never given
+ * back to the system.
+ */
+#define MAGAZINE_SIZE (64)
 
-  struct {
-    guint julian;               /* Day of the year */
-    guint seconds;              /* Seconds since Midnight */
-  } dst_begin, dst_end;
+typedef struct _GDateTimeMagazine GDateTimeMagazine;
+
+struct _GDateTimeMagazine
+{
+  GDateTimeMagazine *next;              /* Within the depot */
+  guint              n_objects;
+  GDateTime         *objects [MAGAZINE_SIZE];
 };
 
-static GHashTable*
-g_time_zone_get_cache (void)
+typedef struct
 {
-  static GHashTable *hash = NULL;
+  GDateTimeMagazine *loaded;            /* Allocated from and freed to */
+  GDateTimeMagazine *previous;          /* Swapped in before the depot */
+  guint64            hits;              /* Served without the depot */
+  guint64            misses;            /* Served by the depot or g_new() */
+  GSList            *arenas;            /* Pushed arenas, innermost first */
+} GDateTimeCache;
 
-  if (g_once_init_enter ((gsize*)&hash))
-    {
-      GHashTable *h;
+/*
+ * Objects are handed out of blocks which double in size, and are only freed
+ * along with the whole arena.
+ */
+#define ARENA_MIN_BLOCK (256)
+#define ARENA_MAX_BLOCK (65536)
 
-      h = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-      g_once_init_leave ((gsize*)&hash, (gsize)h);
-    }
+struct _GDateTimeArena
+{
+  GSList            *blocks;            /* Allocated blocks, newest first */
+  GDateTime         *next;              /* Next unused object of the newest */
+  GDateTime         *end;               /* End of the newest block */
+  guint              block_size;        /* Objects in the newest block */
+  guint              n_pushed;          /* Pushes not yet popped */
+};
 
-  return hash;
+static GStaticPrivate     cache_key = G_STATIC_PRIVATE_INIT;
+static GStaticMutex       depot_lock = G_STATIC_MUTEX_INIT;
+static GDateTimeMagazine *depot_full = NULL;    /* Holding objects */
+static GDateTimeMagazine *depot_empty = NULL;
+static guint64            depot_hits = 0;       /* Flushed from caches */
+static guint64            depot_misses = 0;
+
+/*
+ * Takes the first magazine of a depot list, or %NULL.  Called with
+ * depot_lock held.
+ */
+static GDateTimeMagazine*
+g_date_time_depot_take (GDateTimeMagazine **list)
+{
+  GDateTimeMagazine *magazine = *list;
+
+  if (magazine)
+    *list = magazine->next;
+
+  return magazine;
 }
 
 /*
- * The built in timezone database is rather difficult to use from libc
- * since there doesn't seem to be a way to get at the information for times
- * other than 1970-2038.  Therefore the following methods do not provide
- * accurate DST information for years not in that range.
- *
- * This method is based upon Mono's implementation which can be found at
- * http://anonsvn.mono-project.com/source/trunk/mono/mono/metadata/icall.c
- * and is dual-licensed under the GPL/LGPL.
- *
- * Authors through derivative works:
- *   Dietmar Maurer (dietmar@ximian.com)
- *   Paolo Molaro (lupus@ximian.com)
- *   Patrik Torstensson (patrik.torstensson@labs2.com)
- *
- * Copyright 2001-2003 Ximian, Inc (http://www.ximian.com)
- * Copyright 2004-2009 Novell, Inc (http://www.novell.com)
+ * Puts @magazine onto the depot list it belongs to, and adds the counters
+ * of @cache to the totals.  Called with depot_lock held.
  */
-static gint
-gmt_offset (struct tm *tm,
-            time_t     t)
-{
-#if defined (HAVE_TM_GMTOFF)
-  return tm->tm_gmtoff;
-#else
-  struct tm g;
-  time_t t2;
-  g = *gmtime (&t);
-  g.tm_isdst = tm->tm_isdst;
-  t2 = mktime (&g);
-  return (int)difftime (t, t2);
-#endif
+static void
+g_date_time_depot_put (GDateTimeCache    *cache,
+                       GDateTimeMagazine *magazine)
+{
+  GDateTimeMagazine **list;
+
+  list = magazine->n_objects ? &depot_full : &depot_empty;
+  magazine->next = *list;
+  *list = magazine;
+
+  depot_hits += cache->hits;
+  depot_misses += cache->misses;
+  cache->hits = 0;
+  cache->misses = 0;
 }
 
-static GTimeZone*
-g_time_zone_new_from_year (gint year)
-{
-  static GStaticRWLock  hash_lock = G_STATIC_RW_LOCK_INIT;
-  GHashTable           *hash;
-  GTimeZone            *tz = NULL;
-  gboolean              limited     = FALSE,
-                        is_daylight = FALSE;
-  gint64                julian;
-  gint                  gmtoff,
-                        day;
-  time_t                t;
-  struct tm             tt, start;
-  gchar                 tzone [64],
-                        key [32];
-
-  if ((year < 1970) || (year > 2037))
-    {
-      limited = TRUE;
-      year = 1970;
-    }
+/*
+ * Hands the magazines of an exiting thread to the depot.
+ */
+static void
+g_date_time_cache_free (gpointer data)
+{
+  GDateTimeCache *cache = data;
 
-  memset (&start, 0, sizeof (start));
+  g_static_mutex_lock (&depot_lock);
+  g_date_time_depot_put (cache, cache->loaded);
+  g_date_time_depot_put (cache, cache->previous);
+  g_static_mutex_unlock (&depot_lock);
 
-  start.tm_mday = 1;
-  start.tm_year = year - 1900;
+  g_slist_free (cache->arenas);
+  g_free (cache);
+}
 
-  t = mktime (&start);
+static GDateTimeCache*
+g_date_time_cache_get (void)
+{
+  GDateTimeCache *cache;
 
-  gmtoff = gmt_offset (&start, t);
-  g_snprintf(key, sizeof(key), "%d|%d", gmtoff, year);
+  if (G_LIKELY ((cache = g_static_private_get (&cache_key))))
+    return cache;
 
-  hash = g_time_zone_get_cache ();
+  cache = g_new0 (GDateTimeCache, 1);
 
-  g_static_rw_lock_reader_lock (&hash_lock);
-  tz = g_hash_table_lookup (hash, &key);
-  g_static_rw_lock_reader_unlock (&hash_lock);
+  g_static_mutex_lock (&depot_lock);
+  cache->loaded = g_date_time_depot_take (&depot_empty);
+  cache->previous = g_date_time_depot_take (&depot_empty);
+  g_static_mutex_unlock (&depot_lock);
 
-  if (!tz)
-    {
-      g_static_rw_lock_writer_lock (&hash_lock);
-      if (!(tz = g_hash_table_lookup (hash, &key)))
-        {
-          tz = g_slice_new0 (GTimeZone);
-          tz->year = year;
+  if (!cache->loaded)
+    cache->loaded = g_new0 (GDateTimeMagazine, 1);
+  if (!cache->previous)
+    cache->previous = g_new0 (GDateTimeMagazine, 1);
 
-          if (limited)
-            {
-              localtime_r (&t, &tt);
-              strftime (tzone, sizeof (tzone), "%Z", &tt);
-              tz->std_name = g_strdup (tzone);
-              tz->dst_name = g_strdup (tzone);
-            }
-          else
-            {
-              gmtoff = gmt_offset (&start, t);
-
-              /* For each day of the year, calculate the tm_gmtoff */
-              for (day = 0; day < 365; day++)
-                {    
-                  t += 86400;
-                  localtime_r (&t, &tt);
-
-                  /* Check if daylight savings starts or ends here */
-                  if (gmt_offset (&tt, t) != gmtoff)
-                    {    
-                      struct tm tt1; 
-                      time_t    t1;  
-
-                      /* Try to find the exact hour when daylight saving starts/ends. */
-                      t1 = t; 
-                      do { 
-                        t1 -= 3600;
-                        localtime_r (&t1, &tt1);
-                      } while (gmt_offset (&tt1, t1) != gmtoff);
-
-                      /* Try to find the exact minute when daylight saving starts/ends. */
-                      do { 
-                        t1 += 60;
-                        localtime_r (&t1, &tt1);
-                      } while (gmt_offset (&tt1, t1) == gmtoff);
-                      t1 += gmtoff;
-                      strftime (tzone, sizeof (tzone), "%Z", &tt);
-          
-                      /* Write data, if we're already in daylight saving, we're done. */
-                      if (is_daylight)
-                        {
-                          tz->std_name = g_strdup (tzone);
-                          TO_JULIAN (tt1.tm_year + 1900, tt1.tm_mon + 1, tt1.tm_mday, &julian);
-                          tz->dst_end.julian = julian;
-                          tz->dst_end.seconds = ((tt1.tm_hour * 3600) +
-                                                 (tt1.tm_min * 60) +
-                                                 (tt1.tm_sec));
-                          goto finished;
-                        }
-                      else
-                        {
-                          tz->dst_name = g_strdup (tzone);
-                          TO_JULIAN (tt1.tm_year + 1900, tt1.tm_mon + 1, tt1.tm_mday, &julian);
-                          tz->dst_begin.julian = julian;
-                          tz->dst_begin.seconds = ((tt1.tm_hour * 60 * 60) +
-                                                   (tt1.tm_min * 60) +
-                                                   (tt1.tm_sec));
-                          is_daylight = 1; 
-                        }    
-
-                      /* This is only set once when we enter daylight saving. */
-                      tz->std_gmtoff = (gint64)gmtoff;
-                      tz->dst_gmtoff = (gint64)(gmt_offset (&tt, t) - gmtoff);
-
-                      gmtoff = gmt_offset (&tt, t);
-                    }
-                }
-
-              if (!is_daylight)
-                {
-                  strftime (tzone, sizeof (tzone), "%Z", &tt);
-                  tz->std_name = g_strdup (tzone);
-                  tz->dst_name = g_strdup (tzone);
-                  tz->std_gmtoff = gmtoff;
-                }
-            }
+  g_static_private_set (&cache_key, cache, g_date_time_cache_free);
 
-        finished:
-          g_hash_table_insert (hash, g_strdup(key), tz);
-          g_static_rw_lock_writer_unlock (&hash_lock);
-        }
+  return cache;
+}
+
+static void
+g_date_time_cache_swap (GDateTimeCache *cache)
+{
+  GDateTimeMagazine *magazine = cache->loaded;
+
+  cache->loaded = cache->previous;
+  cache->previous = magazine;
+}
+
+static GDateTime*
+g_date_time_arena_alloc (GDateTimeArena *arena)
+{
+  GDateTime *datetime;
+
+  if (G_UNLIKELY (arena->next == arena->end))
+    {
+      arena->block_size = CLAMP (arena->block_size * 2,
+                                 ARENA_MIN_BLOCK, ARENA_MAX_BLOCK);
+      arena->next = g_new (GDateTime, arena->block_size);
+      arena->end = arena->next + arena->block_size;
+      arena->blocks = g_slist_prepend (arena->blocks, arena->next);
     }
 
-  return tz;
+  datetime = arena->next++;
+  memset (datetime, 0, sizeof (GDateTime));
+  datetime->ref_count = 1;
+  datetime->arena = TRUE;
+
+  return datetime;
 }
 
 static GDateTime*
 g_date_time_new (void)
 {
-  GDateTime *datetime;
+  GDateTimeCache    *cache;
+  GDateTimeMagazine *magazine;
+  GDateTime         *datetime;
+  guint              i;
 
-  datetime = g_slice_new0 (GDateTime);
+  cache = g_date_time_cache_get ();
+
+  if (G_UNLIKELY (cache->arenas))
+    return g_date_time_arena_alloc (cache->arenas->data);
+
+  if (cache->loaded->n_objects == 0 && cache->previous->n_objects > 0)
+    g_date_time_cache_swap (cache);
+
+  if (G_LIKELY (cache->loaded->n_objects > 0))
+    cache->hits++;
+  else
+    {
+      cache->misses++;
+
+      g_static_mutex_lock (&depot_lock);
+      if ((magazine = g_date_time_depot_take (&depot_full)))
+        {
+          g_date_time_depot_put (cache, cache->loaded);
+          cache->loaded = magazine;
+        }
+      g_static_mutex_unlock (&depot_lock);
+
+      if (!magazine)
+        {
+          datetime = g_new (GDateTime, MAGAZINE_SIZE);
+          for (i = 0; i < MAGAZINE_SIZE; i++)
+            cache->loaded->objects [i] = datetime + i;
+          cache->loaded->n_objects = MAGAZINE_SIZE;
+        }
+    }
+
+  datetime = cache->loaded->objects [--cache->loaded->n_objects];
+  memset (datetime, 0, sizeof (GDateTime));
   datetime->ref_count = 1;
 
   return datetime;
@@ -415,1428 +422,2304 @@ g_date_time_new (void)
 static void
 g_date_time_free (GDateTime *datetime)
 {
-  g_slice_free (GDateTime, datetime);
+  GDateTimeCache    *cache;
+  GDateTimeMagazine *magazine;
+
+  cache = g_date_time_cache_get ();
+
+  if (cache->loaded->n_objects == MAGAZINE_SIZE &&
+      cache->previous->n_objects < MAGAZINE_SIZE)
+    g_date_time_cache_swap (cache);
+
+  if (G_UNLIKELY (cache->loaded->n_objects == MAGAZINE_SIZE))
+    {
+      g_static_mutex_lock (&depot_lock);
+      g_date_time_depot_put (cache, cache->previous);
+      magazine = g_date_time_depot_take (&depot_empty);
+      g_static_mutex_unlock (&depot_lock);
+
+      cache->previous = cache->loaded;
+      cache->loaded = magazine ? magazine : g_new0 (GDateTimeMagazine, 1);
+    }
+
+  cache->loaded->objects [cache->loaded->n_objects++] = datetime;
 }
 
+/*
+ * Stores @tz, which is %NULL for UTC, as the zone of @datetime.  Zones are
+ * stored by their index, and indexed zones are never freed, so no reference
+ * is taken.
+ */
 static void
-g_date_time_get_week_number (GDateTime *datetime,
-                             gint      *week_number,
-                             gint      *day_of_week,
-                             gint      *day_of_year)
+g_date_time_store_zone (GDateTime *datetime,
+                        GTimeZone *tz)
 {
-  gint a, b, c, d, e, f, g, n, s, month, day, year;
+  datetime->zone = tz ? g_time_zone_get_index (tz) : 0;
+}
 
-  g_date_time_get_dmy (datetime, &day, &month, &year);
+/*
+ * Places @datetime in the local zone without changing its instant.  A zone
+ * pushed by the calling thread is stored since it may be popped before the
+ * zone is needed.  Otherwise @datetime is only marked as local, so the local
+ * zone of the process is neither loaded nor indexed here.
+ */
+static void
+g_date_time_store_local (GDateTime *datetime)
+{
+  GTimeZone *tz;
 
-  if (month <= 2)
+  if ((tz = g_time_zone_get_thread_default ()))
     {
-      a = g_date_time_get_year (datetime) - 1;
-      b = (a / 4) - (a / 100) + (a / 400);
-      c = ((a - 1) / 4) - ((a - 1) / 100) + ((a - 1) / 400);
-      s = b - c;
-      e = 0;
-      f = day - 1 + (31 * (month - 1));
+      datetime->local = FALSE;
+      g_date_time_store_zone (datetime, tz);
     }
   else
     {
-      a = year;
-      b = (a / 4) - (a / 100) + (a / 400);
-      c = ((a - 1) / 4) - ((a - 1) / 100) + ((a - 1) / 400);
-      s = b - c;
-      e = s + 1;
-      f = day + (((153 * (month - 3)) + 2) / 5) + 58 + s;
+      datetime->local = TRUE;
+      datetime->zone = 0;
     }
+}
 
-  g = (a + b) % 7;
-  d = (f + g - e) % 7;
-  n = f + 3 - d;
+/*
+ * Retrieves the instant of @datetime as seconds since the Epoch, rounded
+ * down.
+ */
+static gint64
+g_date_time_get_epoch_seconds (GDateTime *datetime)
+{
+  gint64 usec;
 
-  if (week_number)
-    {
-      if (n < 0)
-        *week_number = 53 - ((g - s) / 5);
-      else if (n > 364 + s)
-        *week_number = 1;
-      else
-        *week_number = (n / 7) + 1;
-    }
+  usec = datetime->usec - UNIX_EPOCH_USEC;
 
-  if (day_of_week)
-    *day_of_week = d + 1;
+  if (usec < 0 && usec % USEC_PER_SECOND)
+    return usec / USEC_PER_SECOND - 1;
 
-  if (day_of_year)
-    *day_of_year = f + 1;
+  return usec / USEC_PER_SECOND;
 }
 
-/**
- * g_date_time_add:
- * @datetime: a #GDateTime
- * @timespan: a #GTimeSpan
- *
- * Creates a copy of @datetime and adds the specified timespan to the copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Retrieves the timezone of @datetime, or %NULL for UTC.  Constructors from
+ * an instant only mark a #GDateTime as local, so the local zone is not
+ * looked up until a wall clock field is needed.  Constructors from a wall
+ * clock time do look it up, to find the instant.  Either way the local zone
+ * is looked up again on every use, so a local #GDateTime follows
+ * g_time_zone_refresh().  The local zone is never freed, so no reference is
+ * returned.
  */
-GDateTime*
-g_date_time_add (GDateTime *datetime, /* IN */
-                 GTimeSpan *timespan) /* IN */
+static GTimeZone*
+g_date_time_get_zone (GDateTime *datetime)
 {
-  GDateTime *dt;
+  if (datetime->zone)
+    return g_time_zone_lookup_index (datetime->zone);
 
-  g_return_val_if_fail (datetime != NULL, NULL);
-  g_return_val_if_fail (timespan != NULL, NULL);
-
-  dt = g_date_time_copy (datetime);
-  ADD_USEC (dt, *timespan);
+  if (datetime->local)
+    return g_time_zone_new_local ();
 
-  return dt;
+  return NULL;
 }
 
-/**
- * g_date_time_add_years:
- * @datetime: a #GDateTime
- * @years: the number of years
- *
- * Creates a copy of @datetime and adds the specified number of years to the
- * copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Retrieves the interval of @tz, the zone of @datetime, which the instant
+ * of @datetime falls in.
  */
-GDateTime*
-g_date_time_add_years (GDateTime *datetime, /* IN */
-                       gint       years)    /* IN */
+static gint
+g_date_time_get_interval (GDateTime *datetime,
+                          GTimeZone *tz)
 {
-  GDateTime *dt;
-  gint       day;
+  return g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                    g_date_time_get_epoch_seconds (datetime));
+}
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+/*
+ * Retrieves the wall clock time of @datetime in its zone as microseconds
+ * since the Initial Epoch.  During a leap second this is the wall clock
+ * time of the second before, which is then shown as :60.
+ */
+static gint64
+g_date_time_get_wall (GDateTime *datetime)
+{
+  GTimeZone *tz;
+  gint64     wall = datetime->usec;
 
-  day = g_date_time_get_day_of_month (datetime);
-  if (g_date_time_is_leap_year (datetime) &&
-      g_date_time_get_month (datetime) == 2)
-    if (day == 29)
-      day--;
+  if ((tz = g_date_time_get_zone (datetime)))
+    wall += (gint64)g_time_zone_get_offset (tz,
+      g_date_time_get_interval (datetime, tz)) * USEC_PER_SECOND;
 
-  dt = g_date_time_new_from_date (
-    g_date_time_get_year (datetime) + years,
-    g_date_time_get_month (datetime),
-    day);
-  dt->usec = datetime->usec;
+  if (G_UNLIKELY (datetime->leap))
+    wall -= USEC_PER_SECOND;
 
-  return dt;
+  return wall;
 }
 
-/**
- * g_date_time_add_months:
- * @datetime: a #GDateTime
- * @months: the number of months
- *
- * Creates a copy of @datetime and adds the specified number of months to the
- * copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Sets @datetime to the instant at which the wall clock in its zone shows
+ * @wall, in microseconds since the Initial Epoch.  Skipped wall clock times
+ * are read with the offset before the transition and repeated ones resolve
+ * to the later instant, see g_time_zone_find_interval().  With @leap, the
+ * instant is the leap second following @wall.
  */
-GDateTime*
-g_date_time_add_months (GDateTime *datetime, /* IN */
-                        gint       months)   /* IN */
+static void
+g_date_time_set_wall (GDateTime *datetime,
+                      gint64     wall,
+                      gboolean   leap)
 {
-  GDateTime     *dt;
-  gint           year,
-                 month,
-                 day,
-                 i,
-                 a;
-  const guint16 *days;
-
-  g_return_val_if_fail (datetime != NULL, NULL);
-  g_return_val_if_fail (months != 0, NULL);
+  GTimeZone *tz;
+  gint64     local;
 
-  month = g_date_time_get_month (datetime);
-  year = g_date_time_get_year (datetime);
-  a = months > 0 ? 1 : -1;
+  datetime->usec = wall;
+  datetime->leap = leap;
 
-  for (i = 0; i < ABS (months); i++)
+  if ((tz = g_date_time_get_zone (datetime)))
     {
-      month += a;
-      if (month < 1)
-        {
-          year--;
-          month = 12;
-        }
-      else if (month > 12)
-        {
-          year++;
-          month = 1;
-        }
+      local = (wall - UNIX_EPOCH_USEC) / USEC_PER_SECOND;
+      if ((wall - UNIX_EPOCH_USEC) % USEC_PER_SECOND < 0)
+        local--;
+
+      datetime->usec -= (gint64)g_time_zone_get_offset (tz,
+        g_time_zone_find_interval (tz, G_TIME_TYPE_LOCAL, local))
+        * USEC_PER_SECOND;
     }
 
-  day = g_date_time_get_day_of_month (datetime);
-  days = days_in_months [GREGORIAN_LEAP (year) ? 1 : 0];
+  if (G_UNLIKELY (leap))
+    datetime->usec += USEC_PER_SECOND;
+}
 
-  if (days [month] < day)
-    day = days [month];
+/*
+ * Retrieves the Julian Day Number of the date of @datetime in its zone.
+ */
+static gint
+g_date_time_get_julian_day (GDateTime *datetime)
+{
+  gint64 wall,
+         days;
 
-  dt = g_date_time_new_from_date (year, month, day);
-  dt->usec = datetime->usec;
+  wall = g_date_time_get_wall (datetime);
+  days = wall / USEC_PER_DAY;
+  if (wall % USEC_PER_DAY < 0)
+    days--;
 
-  return dt;
+  return days;
 }
 
-/**
- * g_date_time_add_weeks:
- * @datetime: a #GDateTime
- * @weeks: the number of weeks
- *
- * Creates a copy of @datetime and adds the specified number of weeks to the
- * copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Retrieves the microseconds since Midnight of the wall clock time of
+ * @datetime.  During a leap second these are of the second before.
  */
-GDateTime*
-g_date_time_add_weeks (GDateTime *datetime, /* IN */
-                       gint       weeks)    /* IN */
+static gint64
+g_date_time_get_day_usec (GDateTime *datetime)
 {
-  g_return_val_if_fail (datetime != NULL, NULL);
-  return g_date_time_add_days (datetime, weeks * 7);
-}
+  gint64 usec;
 
-/**
- * g_date_time_add_days:
- * @datetime: a #GDateTime
- * @days: the number of days
- *
- * Creates a copy of @datetime and adds the specified number of days to the
- * copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
- */
-GDateTime*
-g_date_time_add_days (GDateTime *datetime, /* IN */
-                      gint       days)     /* IN */
-{
-  GDateTime *dt;
+  usec = g_date_time_get_wall (datetime) % USEC_PER_DAY;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  return usec < 0 ? usec + USEC_PER_DAY : usec;
+}
 
-  dt = g_date_time_copy (datetime);
-  ADD_DAYS (dt, days);
+/*
+ * Places @datetime, created as a wall clock time in UTC, in the local zone
+ * with the same wall clock time.  Finding the instant needs the local zone,
+ * so unlike g_date_time_store_local() this loads it.
+ */
+static void
+g_date_time_set_local (GDateTime *datetime)
+{
+  gint64 wall;
 
-  return dt;
+  wall = g_date_time_get_wall (datetime);
+  g_date_time_store_local (datetime);
+  g_date_time_set_wall (datetime, wall, datetime->leap);
 }
 
-/**
- * g_date_time_add_hours:
- * @datetime: a #GDateTime
- * @hours: the number of hours
- *
- * Creates a copy of @datetime and adds the specified number of hours to the
- * copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Sets @datetime to @usec microseconds after Midnight on the given date as
+ * a wall clock time in its zone, which must already be stored.  With @leap,
+ * it is the leap second following that.  Returns %FALSE if the date is
+ * outside of the representable range.
  */
-GDateTime*
-g_date_time_add_hours (GDateTime *datetime, /* IN */
-                       gint       hours)    /* IN */
+static gboolean
+g_date_time_init_date (GDateTime *datetime,
+                       gint       year,
+                       gint       month,
+                       gint       day,
+                       gint64     usec,
+                       gboolean   leap)
 {
-  GDateTime *dt;
-  gint64     usec;
+  gint julian;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (year > -4712 && year <= 3268, FALSE);
+  g_return_val_if_fail (month > 0 && month <= 12, FALSE);
+  g_return_val_if_fail (day > 0 && day <= 31, FALSE);
 
-  usec = hours * USEC_PER_HOUR;
-  dt = g_date_time_copy (datetime);
-  ADD_USEC (dt, usec);
+  TO_JULIAN (year, month, day, &julian);
+  g_date_time_set_wall (datetime, julian * USEC_PER_DAY + usec, leap);
 
-  return dt;
+  return TRUE;
 }
 
-/**
- * g_date_time_add_seconds:
- * @datetime: a #GDateTime
- * @seconds: the number of seconds
- *
- * Creates a copy of @datetime and adds the specified number of seconds
- * to the copy.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Sets @datetime to the given date and time as a wall clock time in its
+ * zone, which must already be stored.  Returns %FALSE if it is outside of
+ * the representable range.
  */
-GDateTime*
-g_date_time_add_seconds (GDateTime *datetime, /* IN */
-                         gint       seconds)  /* IN */
+static gboolean
+g_date_time_init_full (GDateTime *datetime,
+                       gint       year,
+                       gint       month,
+                       gint       day,
+                       gint       hour,
+                       gint       minute,
+                       gint       second)
 {
-  GDateTime *dt;
-  gint64     usec;
+  gint64   usec;
+  gboolean leap;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (hour >= 0 && hour < 24, FALSE);
+  g_return_val_if_fail (minute >= 0 && minute < 60, FALSE);
+  g_return_val_if_fail (second >= 0 && second <= 60, FALSE);
 
-  dt = g_date_time_copy (datetime);
-  usec = seconds * USEC_PER_SECOND;  
-  ADD_USEC (dt, usec);
+  usec = (hour   * USEC_PER_HOUR)
+       + (minute * USEC_PER_MINUTE)
+       + (second * USEC_PER_SECOND);
 
-  return dt;
+  /* 23:59:60 is the leap second following 23:59:59 */
+  if ((leap = usec >= USEC_PER_DAY))
+    usec -= USEC_PER_SECOND;
+
+  return g_date_time_init_date (datetime, year, month, day, usec, leap);
 }
 
-/**
- * g_date_time_add_milliseconds:
- * @datetime: a #GDateTime
- * @milliseconds: the number of milliseconds
- *
- * Creates a new #GDateTime adding the specified milliseconds @milliseconds to
- * the current date and time.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Sets @datetime to the instant @secs seconds and @usec microseconds after
+ * the Epoch.  The zone of @datetime is left for the caller to store.
  */
-GDateTime*
-g_date_time_add_milliseconds (GDateTime *datetime,     /* IN */
-                              gint       milliseconds) /* IN */
+static void
+g_date_time_init_from_epoch (GDateTime *datetime,
+                             gint64     secs,
+                             gint64     usec)
+{
+  datetime->usec = UNIX_EPOCH_USEC + secs * USEC_PER_SECOND + usec;
+  datetime->local = FALSE;
+  datetime->leap = FALSE;
+}
+
+/*
+ * Creates a new #GDateTime at Midnight on the given date within @tz, which
+ * is %NULL for UTC.
+ */
+static GDateTime*
+g_date_time_new_from_date_with_zone (GTimeZone *tz,
+                                     gint       year,
+                                     gint       month,
+                                     gint       day)
 {
   GDateTime *dt;
-  guint64    usec;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  dt = g_date_time_new ();
+  g_date_time_store_zone (dt, tz);
 
-  dt = g_date_time_copy (datetime);
-  usec = milliseconds * USEC_PER_MILLISECOND;
-  ADD_USEC (dt, usec);
+  if (!g_date_time_init_date (dt, year, month, day, 0, FALSE))
+    {
+      g_date_time_free (dt);
+      return NULL;
+    }
 
   return dt;
 }
 
-/**
- * g_date_time_add_minutes:
- * @datetime: a #GDateTime
- * @minutes: the number of minutes to add
- *
- * Creates a new #GDateTime adding the specified number of minutes.
- *
- * Return value: the newly created #GDateTime which should be freed with
- * g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Creates a new #GDateTime for the instant @secs seconds and @usec
+ * microseconds after the Epoch, as a wall clock time in @tz.
  */
-GDateTime*
-g_date_time_add_minutes (GDateTime *datetime, /* IN */
-                         gint       minutes)  /* IN */
+static GDateTime*
+g_date_time_new_from_epoch (GTimeZone *tz,
+                            gint64     secs,
+                            gint64     usec)
 {
   GDateTime *dt;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
-
-  dt = g_date_time_copy (datetime);
-  ADD_USEC (dt, minutes * USEC_PER_MINUTE);
+  dt = g_date_time_new ();
+  g_date_time_init_from_epoch (dt, secs, usec);
+  g_date_time_store_zone (dt, tz);
 
   return dt;
 }
 
-/**
- * g_date_time_add_full:
- * @datetime: a #GDateTime
- * @years: the number of years to add
- * @months: the number of months to add
- * @days: the number of days to add
- * @hours: the number of hours to add
- * @minutes: the number of minutes to add
- * @seconds: the number of seconds to add
- *
- * Creates a new #GDateTime adding the specified values to the current date and
- * time in @datetime.
- *
- * Return value: the newly created #GDateTime that should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Moves @datetime by @years in the gregorian calendar, keeping its wall
+ * clock time.  February 29th of a leap year becomes February 28th.
  */
-GDateTime*
-g_date_time_add_full (GDateTime *datetime, /* IN */
-                      gint       years,    /* IN */
-                      gint       months,   /* IN */
-                      gint       days,     /* IN */
-                      gint       hours,    /* IN */
-                      gint       minutes,  /* IN */
-                      gint       seconds)  /* IN */
+static void
+g_date_time_shift_years (GDateTime *datetime,
+                         gint       years)
 {
-  GDateTime *tmp, *dt;
+  gint day;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  day = g_date_time_get_day_of_month (datetime);
+  if (g_date_time_is_leap_year (datetime) &&
+      g_date_time_get_month (datetime) == 2)
+    if (day == 29)
+      day--;
 
-  dt = g_date_time_add_years (datetime, years);
-  tmp = dt;
+  g_date_time_init_date (datetime,
+                         g_date_time_get_year (datetime) + years,
+                         g_date_time_get_month (datetime),
+                         day,
+                         g_date_time_get_day_usec (datetime),
+                         datetime->leap);
+}
 
-  dt = g_date_time_add_months (tmp, months);
-  g_date_time_unref (tmp);
-  tmp = dt;
+/*
+ * Moves @datetime by @months in the gregorian calendar, keeping its wall
+ * clock time.  Days past the end of the resulting month become its last.
+ */
+static void
+g_date_time_shift_months (GDateTime *datetime,
+                          gint       months)
+{
+  gint           year,
+                 month,
+                 day,
+                 i,
+                 a;
+  const guint16 *days;
 
-  dt = g_date_time_add_days (tmp, days);
-  g_date_time_unref (tmp);
-  tmp = dt;
+  month = g_date_time_get_month (datetime);
+  year = g_date_time_get_year (datetime);
+  a = months > 0 ? 1 : -1;
 
-  dt = g_date_time_add_hours (tmp, hours);
-  g_date_time_unref (tmp);
-  tmp = dt;
+  for (i = 0; i < ABS (months); i++)
+    {
+      month += a;
+      if (month < 1)
+        {
+          year--;
+          month = 12;
+        }
+      else if (month > 12)
+        {
+          year++;
+          month = 1;
+        }
+    }
 
-  dt = g_date_time_add_minutes (tmp, minutes);
-  g_date_time_unref (tmp);
-  tmp = dt;
+  day = g_date_time_get_day_of_month (datetime);
+  days = days_in_months [GREGORIAN_LEAP (year) ? 1 : 0];
 
-  dt = g_date_time_add_seconds (tmp, seconds);
-  g_date_time_unref (tmp);
+  if (days [month] < day)
+    day = days [month];
 
-  return dt;
+  g_date_time_init_date (datetime, year, month, day,
+                         g_date_time_get_day_usec (datetime),
+                         datetime->leap);
 }
 
-/**
- * g_date_time_compare:
- * @dt1: first #GDateTime to compare
- * @dt2: second #GDateTime to compare
- *
- * qsort()-style comparison for #GDateTime<!-- -->'s. Both #GDateTime<-- -->'s
- * must be non-%NULL.
- *
- * Return value: 0 for equal, less than zero if dt1 is less than dt2, greater
- *   than zero if dt2 is greator than dt1.
- *
- * Since: 2.26
+/*
+ * Moves @datetime by @days, keeping its wall clock time.
  */
-gint
-g_date_time_compare (gconstpointer dt1, /* IN */
-                     gconstpointer dt2) /* IN */
+static void
+g_date_time_shift_days (GDateTime *datetime,
+                        gint       days)
 {
-  const GDateTime *a, *b;
+  g_date_time_set_wall (datetime,
+                        g_date_time_get_wall (datetime)
+                        + (gint64)days * USEC_PER_DAY,
+                        datetime->leap);
+}
 
-  a = dt1;
-  b = dt2;
+/*
+ * Moves @datetime to the same instant as a wall clock time in @tz, which is
+ * %NULL for UTC.
+ */
+static void
+g_date_time_set_zone (GDateTime *datetime,
+                      GTimeZone *tz)
+{
+  datetime->local = FALSE;
+  g_date_time_store_zone (datetime, tz);
+}
 
-  if ((a->period == b->period) &&
-      (a->julian == b->julian) &&
-      (a->usec == b->usec))
-    return 0;
-  else if ((a->period > b->period) ||
-           ((a->period == b->period) && (a->julian > b->julian)) ||
-           ((a->period == b->period) && (a->julian == b->julian) && a->usec > b->usec))
-    return 1;
-  else
-    return -1;
+/*
+ * Copies the date, time and zone of @value into @datetime, leaving how
+ * @datetime was allocated and its reference count alone.
+ */
+static void
+g_date_time_copy_value (GDateTime            *datetime,
+                        const GDateTimeValue *value)
+{
+  datetime->usec = value->usec;
+  datetime->local = value->local;
+  datetime->leap = value->leap;
+  datetime->zone = value->zone;
 }
 
-/**
- * g_date_time_copy:
- * @datetime: a #GDateTime
- *
- * Creates a copy of @datetime.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Loads @value into @datetime, which lives on the stack of the caller and
+ * so is never referenced or freed.
  */
-GDateTime*
-g_date_time_copy (GDateTime *datetime) /* IN */
+static void
+g_date_time_load_value (GDateTime            *datetime,
+                        const GDateTimeValue *value)
 {
-  GDateTime *copied;
+  g_date_time_copy_value (datetime, value);
+  datetime->arena = FALSE;
+  datetime->ref_count = 1;
+}
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+/*
+ * Retrieves the instant of @datetime as seconds of International Atomic
+ * Time since the Epoch, storing the fraction of the second in @usec.  A
+ * leap second counts as the one inserted before the stored instant, if one
+ * was inserted there.
+ */
+static gint64
+g_date_time_get_tai (GDateTime *datetime,
+                     gint64    *usec)
+{
+  gint64 utc;
+  gint   offset;
 
-  copied = g_date_time_new ();
-  copied->period = datetime->period;
-  copied->julian = datetime->julian;
-  copied->usec = datetime->usec;
-  copied->tz = datetime->tz;
+  utc = g_date_time_get_epoch_seconds (datetime);
+  offset = g_time_zone_get_tai_offset (utc);
 
-  return copied;
+  /* 23:59:60 is stored as the following second */
+  if (G_UNLIKELY (datetime->leap) &&
+      g_time_zone_get_tai_offset (utc - 1) < offset)
+    offset--;
+
+  *usec = datetime->usec - UNIX_EPOCH_USEC - utc * USEC_PER_SECOND;
+
+  return utc + offset;
 }
 
-/**
- * g_date_time_date:
- * @datetime: a #GDateTime
- *
- * Creates a new #GDateTime at Midnight on the date represented by @datetime.
- *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
- *
- * Since: 2.26
+/*
+ * Creates a new #GDateTime in UTC for the instant @tai seconds of
+ * International Atomic Time after the Epoch.  Leap seconds are given the
+ * wall clock time 23:59:60.
  */
-GDateTime*
-g_date_time_date (GDateTime *datetime) /* IN */
+static GDateTime*
+g_date_time_new_from_tai_seconds (gint64 tai)
 {
-  GDateTime *date;
+  GDateTime *dt;
+  gint64     utc;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  /* TAI is ahead of UTC, so this is at most a second early */
+  utc = tai - g_time_zone_get_tai_offset (tai);
+  if (utc + g_time_zone_get_tai_offset (utc) == tai)
+    return g_date_time_new_from_epoch (NULL, utc, 0);
 
-  date = g_date_time_copy (datetime);
-  date->usec = 0;
+  utc++;
+  if (utc + g_time_zone_get_tai_offset (utc) == tai)
+    return g_date_time_new_from_epoch (NULL, utc, 0);
 
-  return date;
+  /* Neither second matches, so @tai is the leap second before utc */
+  dt = g_date_time_new_from_epoch (NULL, utc - 1, 0);
+  dt->usec += USEC_PER_SECOND;
+  dt->leap = TRUE;
+
+  return dt;
 }
 
-/**
- * g_date_time_diff:
- * @begin: a #GDateTime
- * @end: a #GDateTime
- * @timespan: a #GTimeSpan
- *
- * Calculates the known difference in time between @begin and @end.  Since the
- * exact precision cannot always be known due to incomplete historic
- * information, a best attempt is made to calculate the difference.
- *
- * Since: 2.26
+/*
+ * Loads the local zone, the table of leap seconds and the zones named by
+ * @data, a %NULL-terminated array which is freed afterwards.
  */
-void
-g_date_time_diff (GDateTime *begin,    /* IN */
-                  GDateTime *end,      /* IN */
-                  GTimeSpan *timespan) /* OUT */
+static gpointer
+g_date_time_warm_up_func (gpointer data)
 {
-  gint64 usec;
-  gint   days;
+  gchar **identifiers = data;
+  gint    i;
 
-  g_return_if_fail (begin != NULL);
-  g_return_if_fail (end != NULL);
-  g_return_if_fail (timespan != NULL);
+  g_time_zone_new_local ();
+  g_time_zone_get_tai_offset (0);
+
+  for (i = 0; identifiers && identifiers [i]; i++)
+    g_time_zone_new (identifiers [i]);
+
+  g_strfreev (identifiers);
+
+  return NULL;
+}
+
+static void
+g_date_time_get_week_number (GDateTime *datetime,
+                             gint      *week_number,
+                             gint      *day_of_week,
+                             gint      *day_of_year)
+{
+  gint a, b, c, d, e, f, g, n, s, month, day, year;
+
+  g_date_time_get_dmy (datetime, &day, &month, &year);
+
+  if (month <= 2)
+    {
+      a = g_date_time_get_year (datetime) - 1;
+      b = (a / 4) - (a / 100) + (a / 400);
+      c = ((a - 1) / 4) - ((a - 1) / 100) + ((a - 1) / 400);
+      s = b - c;
+      e = 0;
+      f = day - 1 + (31 * (month - 1));
+    }
+  else
+    {
+      a = year;
+      b = (a / 4) - (a / 100) + (a / 400);
+      c = ((a - 1) / 4) - ((a - 1) / 100) + ((a - 1) / 400);
+      s = b - c;
+      e = s + 1;
+      f = day + (((153 * (month - 3)) + 2) / 5) + 58 + s;
+    }
+
+  g = (a + b) % 7;
+  d = (f + g - e) % 7;
+  n = f + 3 - d;
 
-  if (begin->period != 0 || end->period != 0)
+  if (week_number)
     {
-      g_warning ("%s only supports current julian epoch", G_STRFUNC);
-      *timespan = 0;
-      return;
+      if (n < 0)
+        *week_number = 53 - ((g - s) / 5);
+      else if (n > 364 + s)
+        *week_number = 1;
+      else
+        *week_number = (n / 7) + 1;
     }
 
-  days = end->julian - begin->julian;
-  usec = end->usec - begin->usec;
+  if (day_of_week)
+    *day_of_week = d + 1;
 
-  *timespan = (days * USEC_PER_DAY) + (end->usec - begin->usec);
+  if (day_of_year)
+    *day_of_year = f + 1;
 }
 
 /**
- * g_date_time_equal:
- * @dt1: a #GDateTime
- * @dt2: a #GDateTime
+ * g_date_time_add:
+ * @datetime: a #GDateTime
+ * @timespan: a #GTimeSpan
  *
- * Checks to see if @dt1 and @dt2 are equal.
+ * Creates a copy of @datetime and adds the specified timespan to the copy.
  *
- * Return value: %TRUE if @dt1 and @dt2 are equal
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gboolean
-g_date_time_equal (gconstpointer dt1, /* IN */
-                   gconstpointer dt2) /* IN */
+GDateTime*
+g_date_time_add (GDateTime *datetime, /* IN */
+                 GTimeSpan *timespan) /* IN */
 {
-  const GDateTime *a, *b;
+  GDateTime *dt;
 
-  a = dt1;
-  b = dt2;
+  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (timespan != NULL, NULL);
 
-  /* TODO: Check timezone offset */
+  dt = g_date_time_copy (datetime);
+  ADD_USEC (dt, *timespan);
 
-  return ((a->period == b->period) &&
-          (a->julian == b->julian) &&
-          (a->usec == b->usec));
+  return dt;
 }
 
 /**
- * g_date_time_get_day_of_week:
+ * g_date_time_add_years:
  * @datetime: a #GDateTime
+ * @years: the number of years
  *
- * Retrieves the day of the week represented by @datetime within the gregorian
- * calendar. 1 is Sunday, 2 is Monday, etc.
+ * Creates a copy of @datetime and adds the specified number of years to the
+ * copy.
  *
- * Return value: the day of the week
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_day_of_week (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_years (GDateTime *datetime, /* IN */
+                       gint       years)    /* IN */
 {
-  gint a, y, m,
-       year  = 0,
-       month = 0,
-       day   = 0,
-       dow;
-
-  g_return_val_if_fail (datetime != NULL, 0);
+  GDateTime *dt;
 
-  /* See Calendar FAQ Section 2.6 for algorithm information */
+  g_return_val_if_fail (datetime != NULL, NULL);
 
-  g_date_time_get_dmy (datetime, &day, &month, &year);
-  a = (14 - month) / 12;
-  y = year - a;
-  m = month + (12 * a) - 2;
-  dow = ((day + y + (y / 4) - (y / 100) + (y / 400) + (31 * m) / 12) % 7);
+  dt = g_date_time_copy (datetime);
+  g_date_time_shift_years (dt, years);
 
-  /* 1 is Monday and 7 is Sunday */
-  return (dow == 0) ? 7 : dow;
+  return dt;
 }
 
 /**
- * g_date_time_get_day_of_month:
+ * g_date_time_add_months:
  * @datetime: a #GDateTime
+ * @months: the number of months
  *
- * Retrieves the day of the month represented by @datetime in the gregorian
- * calendar.
+ * Creates a copy of @datetime and adds the specified number of months to the
+ * copy.
  *
- * Return value: the day of the month
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_day_of_month (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_months (GDateTime *datetime, /* IN */
+                        gint       months)   /* IN */
 {
-  gint           day_of_year,
-                 i;
-  const guint16 *days;
-  guint16        last = 0;
-
-  g_return_val_if_fail (datetime != NULL, 0);
+  GDateTime *dt;
 
-  days = days_in_year [g_date_time_is_leap_year (datetime)? 1 : 0];
-  g_date_time_get_week_number (datetime, NULL, NULL, &day_of_year);
+  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (months != 0, NULL);
 
-  for (i = 1; i <= 12; i++)
-    {
-      if (days [i] >= day_of_year)
-        return day_of_year - last;
-      last = days [i];
-    }
+  dt = g_date_time_copy (datetime);
+  g_date_time_shift_months (dt, months);
 
-  g_warn_if_reached ();
-  return 0;
+  return dt;
 }
 
 /**
- * g_date_time_get_day_of_year:
+ * g_date_time_add_weeks:
  * @datetime: a #GDateTime
+ * @weeks: the number of weeks
  *
- * Retrieves the day of the year represented by @datetime in the gregorian
- * calendar.
+ * Creates a copy of @datetime and adds the specified number of weeks to the
+ * copy.
  *
- * Return value: the day of the year
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_day_of_year (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_weeks (GDateTime *datetime, /* IN */
+                       gint       weeks)    /* IN */
 {
-  gint doy = 0;
-
-  g_return_val_if_fail (datetime != NULL, 0);
-
-  g_date_time_get_week_number (datetime, NULL, NULL, &doy);
-  return doy;
+  g_return_val_if_fail (datetime != NULL, NULL);
+  return g_date_time_add_days (datetime, weeks * 7);
 }
 
 /**
- * g_date_time_get_dmy:
- * @datetime: A #GDateTime.
- * @day: A location for the day of the month, or %NULL.
- * @month: A location for the monty of the year, or %NULL.
- * @year: A location for the gregorian year, or %NULL.
+ * g_date_time_add_days:
+ * @datetime: a #GDateTime
+ * @days: the number of days
  *
- * Retrieves the gregorian day, month, and year of a given #GDateTime.
+ * Creates a copy of @datetime and adds the specified number of days to the
+ * copy.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-void
-g_date_time_get_dmy (GDateTime *datetime, /* IN */
-                     gint      *day,      /* OUT */
-                     gint      *month,    /* OUT */
-                     gint      *year)     /* OUT */
+GDateTime*
+g_date_time_add_days (GDateTime *datetime, /* IN */
+                      gint       days)     /* IN */
 {
-  gint a, b, c, d, e, m;
-
-  a = datetime->julian + 32044;
-  b = ((4 * a) + 3) / 146097;
-  c = a - ((b * 146097) / 4);
-  d = ((4 * c) + 3) / 1461;
-  e = c - (1461 * d) / 4;
-  m = (5 * e + 2) / 153;
+  GDateTime *dt;
 
-  if (day)
-    *day = e - (((153 * m) + 2) / 5) + 1;
+  g_return_val_if_fail (datetime != NULL, NULL);
 
-  if (month)
-    *month = m + 3 - (12 * (m / 10));
+  dt = g_date_time_copy (datetime);
+  g_date_time_shift_days (dt, days);
 
-  if (year)
-    *year  = (b * 100) + d - 4800 + (m / 10);
+  return dt;
 }
 
 /**
- * g_date_time_get_hour:
+ * g_date_time_add_hours:
  * @datetime: a #GDateTime
+ * @hours: the number of hours
  *
- * Retrieves the hour of the day represented by @datetime in the gregorian
- * calendar.
+ * Creates a copy of @datetime and adds the specified number of hours to the
+ * copy.
  *
- * Return value: the hour of the day
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_hour (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_hours (GDateTime *datetime, /* IN */
+                       gint       hours)    /* IN */
 {
-  g_return_val_if_fail (datetime != NULL, 0);
-  return (datetime->usec / USEC_PER_HOUR);
+  GDateTime *dt;
+  gint64     usec;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  usec = hours * USEC_PER_HOUR;
+  dt = g_date_time_copy (datetime);
+  ADD_USEC (dt, usec);
+
+  return dt;
 }
 
 /**
- * g_date_time_get_julian:
+ * g_date_time_add_seconds:
  * @datetime: a #GDateTime
- * @period: a location for the julian period
- * @julian: a location for the day in the julian period
- * @hour: a location for the hour of the day
- * @minute: a location for the minute of the hour
- * @second: a location for hte second of the minute
+ * @seconds: the number of seconds
  *
- * Retrieves the julian period, day, hour, mintute, and second which @datetime
- * represents in the Julian calendar.
+ * Creates a copy of @datetime and adds the specified number of seconds
+ * to the copy.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-void
-g_date_time_get_julian (GDateTime *datetime, /* IN */
-                        gint      *period,   /* OUT */
-                        gint      *julian,   /* OUT */
-                        gint      *hour,     /* OUT */
-                        gint      *minute,   /* OUT */
-                        gint      *second)   /* OUT */
+GDateTime*
+g_date_time_add_seconds (GDateTime *datetime, /* IN */
+                         gint       seconds)  /* IN */
 {
-  g_return_if_fail (datetime != NULL);
-
-  if (period)
-    *period = datetime->period;
-
-  if (julian)
-    *julian = datetime->julian;
+  GDateTime *dt;
+  gint64     usec;
 
-  if (hour)
-    *hour = (datetime->usec / USEC_PER_HOUR);
+  g_return_val_if_fail (datetime != NULL, NULL);
 
-  if (minute)
-    *minute = (datetime->usec % USEC_PER_HOUR) / USEC_PER_MINUTE;
+  dt = g_date_time_copy (datetime);
+  usec = seconds * USEC_PER_SECOND;  
+  ADD_USEC (dt, usec);
 
-  if (second)
-    *second = (datetime->usec % USEC_PER_MINUTE) / USEC_PER_SECOND;
+  return dt;
 }
 
 /**
- * g_date_time_get_microsecond:
+ * g_date_time_add_milliseconds:
  * @datetime: a #GDateTime
+ * @milliseconds: the number of milliseconds
  *
- * Retrieves the microsecond of the current second represented by @datetime in
- * the gregorian calendar.
+ * Creates a new #GDateTime adding the specified milliseconds @milliseconds to
+ * the current date and time.
  *
- * Return value: the microsecond of the second
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_microsecond (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_milliseconds (GDateTime *datetime,     /* IN */
+                              gint       milliseconds) /* IN */
 {
-  g_return_val_if_fail (datetime != NULL, 0);
-  return (datetime->usec % USEC_PER_SECOND);
+  GDateTime *dt;
+  guint64    usec;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  dt = g_date_time_copy (datetime);
+  usec = milliseconds * USEC_PER_MILLISECOND;
+  ADD_USEC (dt, usec);
+
+  return dt;
 }
 
 /**
- * g_date_time_get_millisecond:
+ * g_date_time_add_minutes:
  * @datetime: a #GDateTime
+ * @minutes: the number of minutes to add
  *
- * Retrieves the millisecond of the current second represented by @datetime in
- * the gregorian calendar.
+ * Creates a new #GDateTime adding the specified number of minutes.
  *
- * Return value: the millisecond of the second
+ * Return value: the newly created #GDateTime which should be freed with
+ * g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_millisecond (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_minutes (GDateTime *datetime, /* IN */
+                         gint       minutes)  /* IN */
 {
-  g_return_val_if_fail (datetime != NULL, 0);
-  return (datetime->usec % USEC_PER_SECOND) / USEC_PER_MILLISECOND;
+  GDateTime *dt;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  dt = g_date_time_copy (datetime);
+  ADD_USEC (dt, minutes * USEC_PER_MINUTE);
+
+  return dt;
 }
 
 /**
- * g_date_time_get_minute:
+ * g_date_time_add_full:
  * @datetime: a #GDateTime
+ * @years: the number of years to add
+ * @months: the number of months to add
+ * @days: the number of days to add
+ * @hours: the number of hours to add
+ * @minutes: the number of minutes to add
+ * @seconds: the number of seconds to add
  *
- * Retrieves the minute of the hour represented by @datetime in the gregorian
- * calendar.
+ * Creates a new #GDateTime adding the specified values to the current date and
+ * time in @datetime.
  *
- * Return value: the minute of the hour
+ * Return value: the newly created #GDateTime that should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_minute (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_add_full (GDateTime *datetime, /* IN */
+                      gint       years,    /* IN */
+                      gint       months,   /* IN */
+                      gint       days,     /* IN */
+                      gint       hours,    /* IN */
+                      gint       minutes,  /* IN */
+                      gint       seconds)  /* IN */
 {
-  g_return_val_if_fail (datetime != NULL, 0);
-  return (datetime->usec % USEC_PER_HOUR) / USEC_PER_MINUTE;
+  GDateTime *dt;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  dt = g_date_time_copy (datetime);
+  g_date_time_shift_years (dt, years);
+  g_date_time_shift_months (dt, months);
+  g_date_time_shift_days (dt, days);
+  ADD_USEC (dt, hours * USEC_PER_HOUR
+              + minutes * USEC_PER_MINUTE
+              + seconds * USEC_PER_SECOND);
+
+  return dt;
 }
 
 /**
- * g_date_time_get_month:
- * @datetime: a #GDateTime
+ * g_date_time_arena_new:
  *
- * Retrieves the month of the year represented by @datetime in the gregorian
- * calendar.
+ * Creates a new #GDateTimeArena.  While it is pushed with
+ * g_date_time_arena_push_thread_default(), every #GDateTime created by the
+ * calling thread, by constructors and by functions such as
+ * g_date_time_add_days() alike, is allocated from it.  Such a #GDateTime is
+ * not reference counted: g_date_time_ref() and g_date_time_unref() do
+ * nothing, and it is released along with the rest of the arena by
+ * g_date_time_arena_free().
  *
- * Return value: the month represented by @datetime
+ * Return value: the newly created #GDateTimeArena, which should be freed
+ *   with g_date_time_arena_free()
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_month (GDateTime *datetime) /* IN */
+GDateTimeArena*
+g_date_time_arena_new (void)
 {
-  gint month;
-
-  g_return_val_if_fail (datetime != NULL, 0);
-
-  g_date_time_get_dmy (datetime, NULL, &month, NULL);
-
-  return month;
+  return g_new0 (GDateTimeArena, 1);
 }
 
 /**
- * g_date_time_get_second:
- * @datetime: a #GDateTime
- *
- * Retrieves the second of the minute represented by @datetime in the gregorian
- * calendar.
+ * g_date_time_arena_free:
+ * @arena: a #GDateTimeArena
  *
- * Return value: the second represented by @datetime
+ * Frees @arena along with every #GDateTime allocated from it, whatever its
+ * reference count.  @arena must not be pushed by any thread.
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_second (GDateTime *datetime) /* IN */
+void
+g_date_time_arena_free (GDateTimeArena *arena) /* IN */
 {
-  g_return_val_if_fail (datetime != NULL, 0);
-  return (datetime->usec % USEC_PER_MINUTE) / USEC_PER_SECOND;
+  GSList *iter;
+
+  g_return_if_fail (arena != NULL);
+  g_return_if_fail (arena->n_pushed == 0);
+
+  for (iter = arena->blocks; iter; iter = iter->next)
+    g_free (iter->data);
+
+  g_slist_free (arena->blocks);
+  g_free (arena);
 }
 
 /**
- * g_date_time_get_utc_offset:
- * @datetime: a #GDateTime
- * @timespan: a #GTimeSpan
+ * g_date_time_arena_push_thread_default:
+ * @arena: a #GDateTimeArena
  *
- * Retrieves the offset from UTC that the local timezone specified by @datetime
- * represents.  If @datetime represents UTC time, then the offset is zero.
+ * Makes the calling thread allocate each new #GDateTime from @arena, until
+ * g_date_time_arena_pop_thread_default() is called.  Pushes may be nested.
+ * An arena may only be pushed by one thread at a time.
  *
  * Since: 2.26
  */
 void
-g_date_time_get_utc_offset (GDateTime *datetime, /* IN */
-                            GTimeSpan *timespan) /* OUT */
+g_date_time_arena_push_thread_default (GDateTimeArena *arena) /* IN */
 {
-  gint offset = 0;
-
-  g_return_if_fail (datetime != NULL);
-  g_return_if_fail (timespan != NULL);
+  GDateTimeCache *cache;
 
-  if (datetime->tz)
-    {
-      if (g_date_time_is_daylight_savings (datetime))
-        offset = datetime->tz->std_gmtoff + datetime->tz->dst_gmtoff;
-      else
-        offset = datetime->tz->std_gmtoff;
-    }
+  g_return_if_fail (arena != NULL);
 
-  *timespan = (gint64)offset * USEC_PER_SECOND;
+  cache = g_date_time_cache_get ();
+  cache->arenas = g_slist_prepend (cache->arenas, arena);
+  arena->n_pushed++;
 }
 
 /**
- * g_date_time_get_year:
- * @datetime: A #GDateTime
+ * g_date_time_arena_pop_thread_default:
+ * @arena: the #GDateTimeArena last pushed by the calling thread
  *
- * Retrieves the year in the gregorian calendar that @datetime represents.
- *
- * Return value: the year of the gregorian calendar
+ * Undoes g_date_time_arena_push_thread_default(), restoring the arena, if
+ * any, that the calling thread used before.
  *
  * Since: 2.26
  */
-gint
-g_date_time_get_year (GDateTime *datetime) /* IN */
+void
+g_date_time_arena_pop_thread_default (GDateTimeArena *arena) /* IN */
 {
-  gint year;
+  GDateTimeCache *cache;
 
-  g_return_val_if_fail (datetime != NULL, 0);
+  cache = g_date_time_cache_get ();
 
-  g_date_time_get_dmy (datetime, NULL, NULL, &year);
+  g_return_if_fail (cache->arenas != NULL && cache->arenas->data == arena);
 
-  return year;
+  cache->arenas = g_slist_delete_link (cache->arenas, cache->arenas);
+  arena->n_pushed--;
 }
 
 /**
- * g_date_time_hash:
- * @datetime: a #GDateTime
+ * g_date_time_compare:
+ * @dt1: first #GDateTime to compare
+ * @dt2: second #GDateTime to compare
  *
- * Hashes @datetime into a #guint suitable for use within #GHashTable.
+ * qsort()-style comparison for #GDateTime<!-- -->'s. Both #GDateTime<-- -->'s
+ * must be non-%NULL.
  *
- * Return value: a #guint containing the hash
+ * Return value: 0 for equal, less than zero if dt1 is less than dt2, greater
+ *   than zero if dt2 is greator than dt1.
  *
  * Since: 2.26
  */
-guint
-g_date_time_hash (gconstpointer datetime) /* IN */
+gint
+g_date_time_compare (gconstpointer dt1, /* IN */
+                     gconstpointer dt2) /* IN */
 {
-  return (guint)(*((guint64*)datetime));
+  const GDateTime *a, *b;
+
+  a = dt1;
+  b = dt2;
+
+  /* A leap second shares the instant of the second after it */
+  if (a->usec != b->usec)
+    return a->usec > b->usec ? 1 : -1;
+
+  return (gint)b->leap - (gint)a->leap;
 }
 
 /**
- * g_date_time_format_for_display:
+ * g_date_time_copy:
  * @datetime: a #GDateTime
  *
- * Formats @datetime into a string suitable for display in a user interface such
- * as a file-browser.
- *
- * An example would be "Yesterday, 4:35 PM".
+ * Creates a copy of @datetime.
  *
- * Return value: the newly allocated string that should be freed using g_free().
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gchar*
-g_date_time_format_for_display (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_copy (GDateTime *datetime) /* IN */
 {
-  GDateTime *today;
-  gint       julian;
+  GDateTime *copied;
 
   g_return_val_if_fail (datetime != NULL, NULL);
 
-  today = g_date_time_today ();
-  julian = today->julian;
-  g_date_time_unref (today);
-
-  if (!datetime->period)
-    {
-      if (julian == datetime->julian)
-        return g_date_time_printf (datetime, Q_("GDateTime|Today, %l:%M %p"));
-      else if (julian == (datetime->julian + 1))
-        return g_date_time_printf (datetime, Q_("GDateTime|Yesterday, %l:%M %p"));
-      else if (julian == (datetime->julian - 1))
-        return g_date_time_printf (datetime, Q_("GDateTime|Tomorrow, %l:%M %p"));
-    }
+  copied = g_date_time_new ();
+  copied->usec = datetime->usec;
+  copied->local = datetime->local;
+  copied->leap = datetime->leap;
+  copied->zone = datetime->zone;
 
-  return g_date_time_printf (datetime, Q_("GDateTime|%b %d, %Y, %l:%M %p"));
+  return copied;
 }
 
 /**
- * g_date_time_is_leap_year:
+ * g_date_time_date:
  * @datetime: a #GDateTime
  *
- * Determines if @datetime represents a date known to fall within a leap year in
- * the gregorian calendar.
+ * Creates a new #GDateTime at Midnight on the date represented by @datetime.
  *
- * Return value: %TRUE if @datetime is a leap year.
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
  *
  * Since: 2.26
  */
-gboolean
-g_date_time_is_leap_year (GDateTime *datetime) /* IN */
+GDateTime*
+g_date_time_date (GDateTime *datetime) /* IN */
 {
-  gint year;
+  GDateTime *date;
 
-  g_return_val_if_fail (datetime != NULL, FALSE);
+  g_return_val_if_fail (datetime != NULL, NULL);
 
-  year = g_date_time_get_year (datetime);
-  return GREGORIAN_LEAP (year);
+  date = g_date_time_copy (datetime);
+  g_date_time_set_wall (date,
+                        g_date_time_get_julian_day (datetime) * USEC_PER_DAY,
+                        FALSE);
+
+  return date;
 }
 
 /**
- * g_date_time_is_daylight_savings:
- * @datetime: a #GDateTime
- *
- * Determines if @datetime represents a date known to fall within daylight
- * savings time in the gregorian calendar.
+ * g_date_time_diff:
+ * @begin: a #GDateTime
+ * @end: a #GDateTime
+ * @timespan: a #GTimeSpan
  *
- * Return value: %TRUE if @datetime falls within daylight savings time.
+ * Calculates the known difference in time between @begin and @end.  Since the
+ * exact precision cannot always be known due to incomplete historic
+ * information, a best attempt is made to calculate the difference.
  *
  * Since: 2.26
  */
-gboolean
-g_date_time_is_daylight_savings (GDateTime *datetime) /* IN */
+void
+g_date_time_diff (GDateTime *begin,    /* IN */
+                  GDateTime *end,      /* IN */
+                  GTimeSpan *timespan) /* OUT */
 {
-  gint begin,
-       end;
+  g_return_if_fail (begin != NULL);
+  g_return_if_fail (end != NULL);
+  g_return_if_fail (timespan != NULL);
 
-  g_return_val_if_fail (datetime != NULL, FALSE);
+  *timespan = end->usec - begin->usec;
+}
 
-  if (!datetime->tz)
-    return FALSE;
+/**
+ * g_date_time_diff_with_leap_seconds:
+ * @begin: a #GDateTime
+ * @end: a #GDateTime
+ * @timespan: a #GTimeSpan
+ *
+ * Calculates the elapsed time between the instants @begin and @end,
+ * including the leap seconds inserted between them.  Unlike
+ * g_date_time_diff(), this is the number of SI seconds a clock running on
+ * International Atomic Time would measure.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_diff_with_leap_seconds (GDateTime *begin,    /* IN */
+                                    GDateTime *end,      /* IN */
+                                    GTimeSpan *timespan) /* OUT */
+{
+  gint64 begin_usec,
+         end_usec,
+         secs;
 
-  begin = datetime->tz->dst_begin.julian;
-  end = datetime->tz->dst_end.julian;
+  g_return_if_fail (begin != NULL);
+  g_return_if_fail (end != NULL);
+  g_return_if_fail (timespan != NULL);
 
-  if (datetime->julian >= begin && datetime->julian <= end)
-    {
-      if (datetime->julian != begin && datetime->julian != end)
-        return TRUE;
-      else if (datetime->julian == begin && datetime->usec >
-          (datetime->tz->dst_begin.seconds * USEC_PER_SECOND))
-        return TRUE;
-      else if (datetime->julian == end && datetime->usec <
-          (datetime->tz->dst_end.seconds * USEC_PER_SECOND))
-        return TRUE;
-    }
+  secs = g_date_time_get_tai (end, &end_usec)
+       - g_date_time_get_tai (begin, &begin_usec);
 
-  return FALSE;
+  *timespan = (secs * USEC_PER_SECOND) + (end_usec - begin_usec);
 }
 
 /**
- * g_date_time_new_from_date:
- * @year: the gregorian year
- * @month: the gregorian month
- * @day: the day in the gregorian month
+ * g_date_time_equal:
+ * @dt1: a #GDateTime
+ * @dt2: a #GDateTime
  *
- * Creates a new #GDateTime using the specified date within the gregorian
- * calendar.
+ * Checks to see if @dt1 and @dt2 are the same instant, whatever their
+ * timezones.
  *
- * Return value: the newly created #GDateTime or %NULL if it is outside of
- *   the representable range.
+ * Return value: %TRUE if @dt1 and @dt2 are equal
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_new_from_date (gint year,  /* IN */
-                           gint month, /* IN */
-                           gint day)   /* IN */
+gboolean
+g_date_time_equal (gconstpointer dt1, /* IN */
+                   gconstpointer dt2) /* IN */
 {
-  GDateTime *dt;
-  gint       julian;
-
-  g_return_val_if_fail (year > -4712 && year <= 3268, NULL);
-  g_return_val_if_fail (month > 0 && month <= 12, NULL);
-  g_return_val_if_fail (day > 0 && day <= 31, NULL);
+  const GDateTime *a, *b;
 
-  dt = g_date_time_new ();
-  TO_JULIAN (year, month, day, &julian);
-  dt->julian = julian;
-  dt->tz = g_time_zone_new_from_year (year);
+  a = dt1;
+  b = dt2;
 
-  return dt;
+  return a->usec == b->usec && a->leap == b->leap;
 }
 
 /**
- * g_date_time_new_from_time_t:
- * @t: a time_t
- *
- * Creates a new #GDateTime using the time since Jan 1, 1970 specified by @t.
+ * g_date_time_get_allocator_stats:
+ * @hits: a location for the number of hits, or %NULL
+ * @misses: a location for the number of misses, or %NULL
  *
- * Return value: the newly created #GDateTime
+ * Retrieves how many #GDateTime<!-- -->s were allocated from the cache kept by
+ * the allocating thread (@hits), and how many needed the shared depot or
+ * fresh memory (@misses).  Counts of other threads are included up to the
+ * last time they visited the depot or exited.
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_new_from_time_t (time_t t) /* IN */
+void
+g_date_time_get_allocator_stats (guint64 *hits,   /* OUT */
+                                 guint64 *misses) /* OUT */
 {
-  struct tm tm;
+  GDateTimeCache *cache;
+
+  cache = g_static_private_get (&cache_key);
 
-  memset (&tm, 0, sizeof (tm));
-  localtime_r (&t, &tm);
+  g_static_mutex_lock (&depot_lock);
 
-  return g_date_time_new_full (tm.tm_year + 1900,
-                               tm.tm_mon  + 1,
-                               tm.tm_mday,
-                               tm.tm_hour,
-                               tm.tm_min,
-                               tm.tm_sec);
+  if (hits)
+    *hits = depot_hits + (cache ? cache->hits : 0);
+  if (misses)
+    *misses = depot_misses + (cache ? cache->misses : 0);
+
+  g_static_mutex_unlock (&depot_lock);
 }
 
 /**
- * g_date_time_new_from_timeval:
- * @tv: #GTimeVal
+ * g_date_time_get_day_of_week:
+ * @datetime: a #GDateTime
  *
- * Creates a new #GDateTime using the date and time specified by #GTimeVal.
+ * Retrieves the day of the week represented by @datetime within the gregorian
+ * calendar. 1 is Sunday, 2 is Monday, etc.
  *
- * Return value: the newly created #GDateTime
+ * Return value: the day of the week
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_new_from_timeval (GTimeVal *tv) /* IN */
+gint
+g_date_time_get_day_of_week (GDateTime *datetime) /* IN */
 {
-  GDateTime *datetime;
-  gint       year;
+  gint a, y, m,
+       year  = 0,
+       month = 0,
+       day   = 0,
+       dow;
 
-  g_return_val_if_fail (tv != NULL, NULL);
+  g_return_val_if_fail (datetime != NULL, 0);
 
-  datetime = g_date_time_new_from_time_t ((time_t)tv->tv_sec);
-  datetime->usec += tv->tv_usec;
-  g_date_time_get_dmy (datetime, NULL, NULL, &year);
-  datetime->tz = g_time_zone_new_from_year (year);
+  /* See Calendar FAQ Section 2.6 for algorithm information */
 
-  return datetime;
+  g_date_time_get_dmy (datetime, &day, &month, &year);
+  a = (14 - month) / 12;
+  y = year - a;
+  m = month + (12 * a) - 2;
+  dow = ((day + y + (y / 4) - (y / 100) + (y / 400) + (31 * m) / 12) % 7);
+
+  /* 1 is Monday and 7 is Sunday */
+  return (dow == 0) ? 7 : dow;
 }
 
 /**
- * g_date_time_new_full:
- * @year: the gregorian year
- * @month: the gregorian month
- * @day: the day of the gregorian month
- * @hour: the hour of the day
- * @minute: the minute of the hour
- * @second: the second of the minute
+ * g_date_time_get_day_of_month:
+ * @datetime: a #GDateTime
  *
- * Creates a new #GDateTime using the date and times in the gregorian calendar.
+ * Retrieves the day of the month represented by @datetime in the gregorian
+ * calendar.
  *
- * Return value: the newly created #GDateTime
+ * Return value: the day of the month
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_new_full (gint year,   /* IN */
-                      gint month,  /* IN */
-                      gint day,    /* IN */
-                      gint hour,   /* IN */
-                      gint minute, /* IN */
-                      gint second) /* IN */
+gint
+g_date_time_get_day_of_month (GDateTime *datetime) /* IN */
 {
-  GDateTime *dt;
-  
-  g_return_val_if_fail (hour >= 0 && hour < 24, NULL);
-  g_return_val_if_fail (minute >= 0 && minute < 60, NULL);
-  g_return_val_if_fail (second >= 0 && second <= 60, NULL);
+  gint           day_of_year,
+                 i;
+  const guint16 *days;
+  guint16        last = 0;
 
-  if (!(dt = g_date_time_new_from_date (year, month, day)))
-    return NULL;
+  g_return_val_if_fail (datetime != NULL, 0);
 
-  dt->usec = (hour   * USEC_PER_HOUR)
-           + (minute * USEC_PER_MINUTE)
-           + (second * USEC_PER_SECOND);
-  dt->tz = g_time_zone_new_from_year (year);
+  days = days_in_year [g_date_time_is_leap_year (datetime)? 1 : 0];
+  g_date_time_get_week_number (datetime, NULL, NULL, &day_of_year);
 
-  return dt;
+  for (i = 1; i <= 12; i++)
+    {
+      if (days [i] >= day_of_year)
+        return day_of_year - last;
+      last = days [i];
+    }
+
+  g_warn_if_reached ();
+  return 0;
 }
 
 /**
- * g_date_time_now:
+ * g_date_time_get_day_of_year:
+ * @datetime: a #GDateTime
  *
- * Creates a new #GDateTime representing the current date and time.
+ * Retrieves the day of the year represented by @datetime in the gregorian
+ * calendar.
  *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
+ * Return value: the day of the year
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_now (void)
+gint
+g_date_time_get_day_of_year (GDateTime *datetime) /* IN */
 {
-  GTimeVal tv;
-  g_get_current_time (&tv);
-  return g_date_time_new_from_timeval (&tv);
+  gint doy = 0;
+
+  g_return_val_if_fail (datetime != NULL, 0);
+
+  g_date_time_get_week_number (datetime, NULL, NULL, &doy);
+  return doy;
 }
 
 /**
- * g_date_time_parse:
- * @input: the string to parse
- *
- * Parses @input using a the set of known formats for date and times.  The
- * parsed date and time is stored in a new #GDateTime and returned.
+ * g_date_time_get_dmy:
+ * @datetime: A #GDateTime.
+ * @day: A location for the day of the month, or %NULL.
+ * @month: A location for the monty of the year, or %NULL.
+ * @year: A location for the gregorian year, or %NULL.
  *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref() or %NULL upon error.
+ * Retrieves the gregorian day, month, and year of a given #GDateTime.
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_parse (const gchar *input) /* IN */
+void
+g_date_time_get_dmy (GDateTime *datetime, /* IN */
+                     gint      *day,      /* OUT */
+                     gint      *month,    /* OUT */
+                     gint      *year)     /* OUT */
 {
-  /* TODO: Implement parsing with locale support */
-  g_warn_if_reached ();
-  return NULL;
+  gint a, b, c, d, e, m;
+
+  a = g_date_time_get_julian_day (datetime) + 32044;
+  b = ((4 * a) + 3) / 146097;
+  c = a - ((b * 146097) / 4);
+  d = ((4 * c) + 3) / 1461;
+  e = c - (1461 * d) / 4;
+  m = (5 * e + 2) / 153;
+
+  if (day)
+    *day = e - (((153 * m) + 2) / 5) + 1;
+
+  if (month)
+    *month = m + 3 - (12 * (m / 10));
+
+  if (year)
+    *year  = (b * 100) + d - 4800 + (m / 10);
 }
 
 /**
- * g_date_time_parse_with_format:
- * @format: the format string
- * @input: the string to parse
- *
- * Parses @input using the @format specified.  The parsed date and time is
- * stored in a new #GDateTime and returned.
- *
- * The following format specifiers are supported:
+ * g_date_time_get_hour:
+ * @datetime: a #GDateTime
  *
- * %%d  The day ranging from 1 to 31.
- * %%H  The hour ranging from 1 to 23.
- * %%I  The hour ranging from 1 to 12. Best used with %%p or %%P.
- * %%m  The month ranging from 1 to 12.
- * %%M  The minute ranging from 1 to 59.
- * %%p  The AM/PM specifier.
- * %%P  The am/pm specifier.
- * %%S  The second ranging from 1 to 60.
- * %%t  A literal tab (\t).
- * %%y  The 2-decimal representation of the year.
+ * Retrieves the hour of the day represented by @datetime in the gregorian
+ * calendar.
  *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref() or %NULL upon error.
+ * Return value: the hour of the day
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_parse_with_format (const gchar *format, /* IN */
-                               const gchar *input)  /* IN */
+gint
+g_date_time_get_hour (GDateTime *datetime) /* IN */
 {
-  gint      year    = 1,
-            month   = 1,
-            day     = 1,
-            hour    = 0,
-            minute  = 0,
-            second  = 0,
-            utf8len,
-            i;
-  gboolean  in_mod   = FALSE,
-            has_ampm = FALSE,
-            is_pm    = FALSE;
-  gchar    *tmpf,
-            buffer [64],
-            c;
-
-  g_return_val_if_fail (format != NULL, NULL);
-  g_return_val_if_fail (g_utf8_validate (format, -1, NULL), NULL);
-  g_return_val_if_fail (input != NULL, NULL);
-  g_return_val_if_fail (g_utf8_validate (input, -1, NULL), NULL);
+  g_return_val_if_fail (datetime != NULL, 0);
 
-  utf8len = g_utf8_strlen (format, -1);
-  memset (buffer, 0, sizeof (buffer));
+  return g_date_time_get_day_usec (datetime) / USEC_PER_HOUR;
+}
 
-  #define HANDLE_INT(p,w,o) G_STMT_START {                                  \
-    memset (buffer, 0, sizeof (buffer));                                    \
-    memcpy (buffer, (p), (w));                                              \
-    *(o) = atoi (buffer);                                                   \
-    input += (w);                                                           \
-  } G_STMT_END
+/**
+ * g_date_time_get_julian:
+ * @datetime: a #GDateTime
+ * @period: a location for the julian period
+ * @julian: a location for the day in the julian period
+ * @hour: a location for the hour of the day
+ * @minute: a location for the minute of the hour
+ * @second: a location for hte second of the minute
+ *
+ * Retrieves the julian period, day, hour, mintute, and second which @datetime
+ * represents in the Julian calendar.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_get_julian (GDateTime *datetime, /* IN */
+                        gint      *period,   /* OUT */
+                        gint      *julian,   /* OUT */
+                        gint      *hour,     /* OUT */
+                        gint      *minute,   /* OUT */
+                        gint      *second)   /* OUT */
+{
+  gint   day,
+         p;
+  gint64 usec;
 
-  for (i = 0; i < utf8len; i++)
-    {
-      tmpf = g_utf8_offset_to_pointer (format, i);
-      c = g_utf8_get_char (tmpf);
+  g_return_if_fail (datetime != NULL);
 
-      if (!in_mod)
-        {
-          if (c == '%')
-            in_mod = TRUE;
-          else
-            {
-              if (tmpf [0] != input [0])
-                goto bad_format;
-              input++;
-            }
-        }
-      else
-        {
-          switch (c) {
-          case '%':
-            if (input [0] != '%')
-              goto bad_format;
-            input++;
-            break;
-          case 'd':
-            HANDLE_INT (input, 2, &day);
-            break;
-          case 'H':
-            HANDLE_INT (input, 2, &hour);
-            break;
-          case 'I':
-            HANDLE_INT (input, 2, &hour);
-            break;
-          case 'M':
-            HANDLE_INT (input, 2, &minute);
-            break;
-          case 'm':
-            HANDLE_INT (input, 2, &month);
-            break;
-          case 'p':
-            has_ampm = TRUE;
-            if (g_str_has_prefix (input, "PM"))
-              is_pm = TRUE;
-            else if (g_str_has_prefix (input, "AM"))
-              is_pm = FALSE;
-            else
-              goto bad_format;
-            input += 2;
-            break;
-          case 'P':
-            has_ampm = TRUE;
-            if (g_str_has_prefix (input, "pm"))
-              is_pm = TRUE;
-            else if (g_str_has_prefix (input, "am"))
-              is_pm = FALSE;
-            else
-              goto bad_format;
-            input += 2;
-            break;
-          case 'S':
-            HANDLE_INT (input, 2, &second);
-            break;
-          case 't':
-            if (input [0] != '\t')
-              goto bad_format;
-            input++;
-            break;
-          case 'y':
-            HANDLE_INT (input, 2, &year);
-            if (year > 70)
-              year += 1900;
-            else
-              year += 2000;
-            break;
-          case 'Y':
-            HANDLE_INT (input, 4, &year);
-            break;
-          default:
-            //goto bad_format;
-            input++;
-            break;
-          }
+  day = g_date_time_get_julian_day (datetime);
+  usec = g_date_time_get_day_usec (datetime);
 
-          in_mod = FALSE;
-        }
-    }
+  /* Periods before the Initial Epoch are negative */
+  p = day / DAYS_PER_PERIOD;
+  if (day % DAYS_PER_PERIOD < 0)
+    p--;
 
-  #undef HANDLE_INT
+  if (period)
+    *period = p;
 
-  if (month < 1 || month > 12)
-    goto bad_value;
-  else if (day < 1 || day > 31)
-    goto bad_value;
-  else if (hour < 0 || hour > 23)
-    goto bad_value;
-  else if (minute < 0 || minute > 59)
-    goto bad_value;
-  else if (second < 0 || second > 60)
-    goto bad_value;
+  if (julian)
+    *julian = day - p * DAYS_PER_PERIOD;
 
-  if (has_ampm)
-    {
-      if (!is_pm && hour == 12)
-        hour = 0;
-      else if (is_pm && hour < 12)
-        hour += 12;
-    }
+  if (hour)
+    *hour = (usec / USEC_PER_HOUR);
 
-  return g_date_time_new_full (year, month, day, hour, minute, second);
+  if (minute)
+    *minute = (usec % USEC_PER_HOUR) / USEC_PER_MINUTE;
 
-bad_format:
-#if 0
-  g_debug ("Bad Format: Expected \"%s\", got \"%s\"", tmpf, input);
-#endif
-  return NULL;
+  if (second)
+    *second = (usec % USEC_PER_MINUTE) / USEC_PER_SECOND;
+}
 
-bad_value:
-#if 0
-  g_debug ("Bad Value: Year=%d, Month=%d, Day=%d, Hour=%d, Minute=%d, Second=%d",
-           year, month, day, hour, minute, second);
-#endif
-  return NULL;
+/**
+ * g_date_time_get_microsecond:
+ * @datetime: a #GDateTime
+ *
+ * Retrieves the microsecond of the current second represented by @datetime in
+ * the gregorian calendar.
+ *
+ * Return value: the microsecond of the second
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_get_microsecond (GDateTime *datetime) /* IN */
+{
+  g_return_val_if_fail (datetime != NULL, 0);
+  return g_date_time_get_day_usec (datetime) % USEC_PER_SECOND;
 }
 
 /**
- * g_date_time_printf:
- * @datetime: A #GDateTime
- * @format: a format string for the #GDateTime
+ * g_date_time_get_millisecond:
+ * @datetime: a #GDateTime
  *
- * Creates a newly allocated string representing the format requested by
- * @format.
+ * Retrieves the millisecond of the current second represented by @datetime in
+ * the gregorian calendar.
  *
- * The following format specifiers are supported:
+ * Return value: the millisecond of the second
  *
- * %%a  The abbreviated weekday name according to the current locale.
- * %%A  The full weekday name according to the current locale.
- * %%b  The abbreviated month name according to the current locale.
- * %%B  The full month name according to the current locale.
- * %%d  The day of the month as a decimal number (range 01 to 31).
- * %%e  The day of the month as a decimal number (range  1 to 31).
- * %%F  Equivalent to %Y-%m-%d (the ISO 8601 date format).
- * %%h  Equivalent to %b.
- * %%H  The hour as a decimal number using a 24-hour clock (range 00 to 23).
- * %%I  The hour as a decimal number using a 12-hour clock (range 01 to 12).
- * %%j  The day of the year as a decimal number (range 001 to 366).
- * %%k  The hour (24-hour clock) as a decimal number (range 0 to 23);
- *      single digits are preceded by a blank.
- * %%l  The hour (12-hour clock) as a decimal number (range 1 to 12);
- *      single digits are preceded by a blank.
- * %%m  The month as a decimal number (range 01 to 12).
- * %%M  The minute as a decimal number (range 00 to 59).
- * %%N  The micro-seconds as a decimal number.
- * %%p  Either "AM" or "PM" according to the given time  value, or the
- *      corresponding  strings  for the current locale.  Noon is treated
- *      as "PM" and midnight as "AM".
- * %%P  Like %%p but lowercase: "am" or "pm" or a corresponding string for
- *      the current locale.
- * %%r  The time in a.m. or p.m. notation.
- * %%R  The time in 24-hour notation (%H:%M).
- * %%s  The number of seconds since the Epoch, that is, since 1970-01-01
- *      00:00:00 UTC.
- * %%S  The second as a decimal number (range 00 to 60).
- * %%t  A tab character.
- * %%u  The day of the week as a decimal, range 1 to 7, Monday being 1.
- * %%W  The week number of the current year as a decimal number.
- * %%x  The preferred date representation for the current locale without
- *      the date.
- * %%X  The preferred date representation for the current locale without
- *      the time.
- * %%y  The year as a decimal number without the century.
- * %%Y  The year as a decimal number including the century.
- * %%z  The timezone or name or abbreviation.
- * %%%  A literal %% character.
+ * Since: 2.26
+ */
+gint
+g_date_time_get_millisecond (GDateTime *datetime) /* IN */
+{
+  g_return_val_if_fail (datetime != NULL, 0);
+  return (g_date_time_get_day_usec (datetime) % USEC_PER_SECOND)
+       / USEC_PER_MILLISECOND;
+}
+
+/**
+ * g_date_time_get_minute:
+ * @datetime: a #GDateTime
  *
- * Return value: a newly allocated string formatted to the requested format or
- *   %NULL in the case that there was an error.  The string should be freed
- *   with g_free().
+ * Retrieves the minute of the hour represented by @datetime in the gregorian
+ * calendar.
+ *
+ * Return value: the minute of the hour
  *
  * Since: 2.26
  */
-gchar*
-g_date_time_printf (GDateTime   *datetime, /* IN */
-                    const gchar *format)   /* IN */
+gint
+g_date_time_get_minute (GDateTime *datetime) /* IN */
 {
-  GString     *outstr;
-  const gchar *tmp;
-  gchar       *tmp2,
-               c;
-  glong        utf8len;
-  gint         i;
-  gboolean     in_mod;
-  
-  g_return_val_if_fail (datetime != NULL, NULL);
-  g_return_val_if_fail (format != NULL, NULL);
-  g_return_val_if_fail (g_utf8_validate (format, -1, NULL), NULL);
-  
-  outstr = g_string_sized_new (strlen (format) * 2);
-  utf8len = g_utf8_strlen (format, -1);
-  in_mod = FALSE;
-  
-  for (i = 0; i < utf8len; i++)
-    {
-      tmp = g_utf8_offset_to_pointer (format, i);
-      c = g_utf8_get_char (tmp);
+  g_return_val_if_fail (datetime != NULL, 0);
 
-      switch (c) {
-      case '%':
-        if (!in_mod)
+  return (g_date_time_get_day_usec (datetime) % USEC_PER_HOUR)
+       / USEC_PER_MINUTE;
+}
+
+/**
+ * g_date_time_get_month:
+ * @datetime: a #GDateTime
+ *
+ * Retrieves the month of the year represented by @datetime in the gregorian
+ * calendar.
+ *
+ * Return value: the month represented by @datetime
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_get_month (GDateTime *datetime) /* IN */
+{
+  gint month;
+
+  g_return_val_if_fail (datetime != NULL, 0);
+
+  g_date_time_get_dmy (datetime, NULL, &month, NULL);
+
+  return month;
+}
+
+/**
+ * g_date_time_get_second:
+ * @datetime: a #GDateTime
+ *
+ * Retrieves the second of the minute represented by @datetime in the gregorian
+ * calendar.
+ *
+ * Return value: the second represented by @datetime
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_get_second (GDateTime *datetime) /* IN */
+{
+  g_return_val_if_fail (datetime != NULL, 0);
+
+  if (G_UNLIKELY (datetime->leap))
+    return 60;
+
+  return (g_date_time_get_day_usec (datetime) % USEC_PER_MINUTE)
+       / USEC_PER_SECOND;
+}
+
+/**
+ * g_date_time_get_utc_offset:
+ * @datetime: a #GDateTime
+ * @timespan: a #GTimeSpan
+ *
+ * Retrieves the offset from UTC that the local timezone specified by @datetime
+ * represents.  If @datetime represents UTC time, then the offset is zero.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_get_utc_offset (GDateTime *datetime, /* IN */
+                            GTimeSpan *timespan) /* OUT */
+{
+  GTimeZone *tz;
+  gint32     offset = 0;
+
+  g_return_if_fail (datetime != NULL);
+  g_return_if_fail (timespan != NULL);
+
+  if ((tz = g_date_time_get_zone (datetime)))
+    offset = g_time_zone_get_offset (tz,
+                                     g_date_time_get_interval (datetime, tz));
+
+  *timespan = (gint64)offset * USEC_PER_SECOND;
+}
+
+/**
+ * g_date_time_get_value:
+ * @datetime: a #GDateTime
+ * @value: a location for the #GDateTimeValue
+ *
+ * Stores @datetime into @value, so that it can be worked on with the
+ * g_date_time_value_*() functions without further allocations.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_get_value (GDateTime      *datetime, /* IN */
+                       GDateTimeValue *value)    /* OUT */
+{
+  g_return_if_fail (datetime != NULL);
+  g_return_if_fail (value != NULL);
+
+  value->usec = datetime->usec;
+  value->local = datetime->local;
+  value->leap = datetime->leap;
+  value->zone = datetime->zone;
+}
+
+/**
+ * g_date_time_get_year:
+ * @datetime: A #GDateTime
+ *
+ * Retrieves the year in the gregorian calendar that @datetime represents.
+ *
+ * Return value: the year of the gregorian calendar
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_get_year (GDateTime *datetime) /* IN */
+{
+  gint year;
+
+  g_return_val_if_fail (datetime != NULL, 0);
+
+  g_date_time_get_dmy (datetime, NULL, NULL, &year);
+
+  return year;
+}
+
+/**
+ * g_date_time_hash:
+ * @datetime: a #GDateTime
+ *
+ * Hashes @datetime into a #guint suitable for use within #GHashTable.
+ *
+ * Return value: a #guint containing the hash
+ *
+ * Since: 2.26
+ */
+guint
+g_date_time_hash (gconstpointer datetime) /* IN */
+{
+  const GDateTime *dt = datetime;
+
+  return (guint)(dt->usec ^ (dt->usec >> 32));
+}
+
+/**
+ * g_date_time_format_for_display:
+ * @datetime: a #GDateTime
+ *
+ * Formats @datetime into a string suitable for display in a user interface such
+ * as a file-browser.
+ *
+ * An example would be "Yesterday, 4:35 PM".
+ *
+ * Return value: the newly allocated string that should be freed using g_free().
+ *
+ * Since: 2.26
+ */
+gchar*
+g_date_time_format_for_display (GDateTime *datetime) /* IN */
+{
+  GDateTime *today;
+  gint       julian,
+             day;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  today = g_date_time_today ();
+  julian = g_date_time_get_julian_day (today);
+  g_date_time_unref (today);
+
+  day = g_date_time_get_julian_day (datetime);
+
+  if (julian == day)
+    return g_date_time_printf (datetime, Q_("GDateTime|Today, %l:%M %p"));
+  else if (julian == (day + 1))
+    return g_date_time_printf (datetime, Q_("GDateTime|Yesterday, %l:%M %p"));
+  else if (julian == (day - 1))
+    return g_date_time_printf (datetime, Q_("GDateTime|Tomorrow, %l:%M %p"));
+
+  return g_date_time_printf (datetime, Q_("GDateTime|%b %d, %Y, %l:%M %p"));
+}
+
+/**
+ * g_date_time_is_leap_year:
+ * @datetime: a #GDateTime
+ *
+ * Determines if @datetime represents a date known to fall within a leap year in
+ * the gregorian calendar.
+ *
+ * Return value: %TRUE if @datetime is a leap year.
+ *
+ * Since: 2.26
+ */
+gboolean
+g_date_time_is_leap_year (GDateTime *datetime) /* IN */
+{
+  gint year;
+
+  g_return_val_if_fail (datetime != NULL, FALSE);
+
+  year = g_date_time_get_year (datetime);
+  return GREGORIAN_LEAP (year);
+}
+
+/**
+ * g_date_time_is_daylight_savings:
+ * @datetime: a #GDateTime
+ *
+ * Determines if @datetime represents a date known to fall within daylight
+ * savings time in the gregorian calendar.
+ *
+ * Return value: %TRUE if @datetime falls within daylight savings time.
+ *
+ * Since: 2.26
+ */
+gboolean
+g_date_time_is_daylight_savings (GDateTime *datetime) /* IN */
+{
+  GTimeZone *tz;
+
+  g_return_val_if_fail (datetime != NULL, FALSE);
+
+  if (!(tz = g_date_time_get_zone (datetime)))
+    return FALSE;
+
+  return g_time_zone_is_dst (tz, g_date_time_get_interval (datetime, tz));
+}
+
+/**
+ * g_date_time_new_from_date:
+ * @year: the gregorian year
+ * @month: the gregorian month
+ * @day: the day in the gregorian month
+ *
+ * Creates a new #GDateTime using the specified date within the gregorian
+ * calendar.
+ *
+ * Return value: the newly created #GDateTime or %NULL if it is outside of
+ *   the representable range.
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_from_date (gint year,  /* IN */
+                           gint month, /* IN */
+                           gint day)   /* IN */
+{
+  GDateTime *dt;
+
+  if ((dt = g_date_time_new_from_date_with_zone (NULL, year, month, day)))
+    g_date_time_set_local (dt);
+
+  return dt;
+}
+
+/**
+ * g_date_time_new_from_gps:
+ * @gps: seconds of GPS time since 1980-01-06 00:00:00 UTC
+ *
+ * Creates a new #GDateTime in UTC for the instant given in GPS time, which
+ * counts leap seconds and is 19 seconds behind International Atomic Time.
+ * Leap seconds are given the wall clock time 23:59:60.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_from_gps (gint64 gps) /* IN */
+{
+  return g_date_time_new_from_tai_seconds (gps + GPS_EPOCH_TAI);
+}
+
+/**
+ * g_date_time_new_from_tai:
+ * @tai: seconds of International Atomic Time since the Epoch
+ *
+ * Creates a new #GDateTime in UTC for the instant given in International
+ * Atomic Time (TAI), counted like g_date_time_to_tai().  Leap seconds are
+ * given the wall clock time 23:59:60.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_from_tai (gint64 tai) /* IN */
+{
+  return g_date_time_new_from_tai_seconds (tai);
+}
+
+/**
+ * g_date_time_new_from_time_t:
+ * @t: a time_t
+ *
+ * Creates a new #GDateTime using the time since Jan 1, 1970 specified by @t.
+ *
+ * Return value: the newly created #GDateTime
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_from_time_t (time_t t) /* IN */
+{
+  GDateTime *dt;
+
+  dt = g_date_time_new_from_epoch (NULL, t, 0);
+  g_date_time_store_local (dt);
+
+  return dt;
+}
+
+/**
+ * g_date_time_new_from_timeval:
+ * @tv: #GTimeVal
+ *
+ * Creates a new #GDateTime using the date and time specified by #GTimeVal.
+ *
+ * Return value: the newly created #GDateTime
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_from_timeval (GTimeVal *tv) /* IN */
+{
+  GDateTime *dt;
+
+  g_return_val_if_fail (tv != NULL, NULL);
+
+  dt = g_date_time_new_from_epoch (NULL, tv->tv_sec, tv->tv_usec);
+  g_date_time_store_local (dt);
+
+  return dt;
+}
+
+/**
+ * g_date_time_new_from_value:
+ * @value: a #GDateTimeValue
+ *
+ * Creates a new #GDateTime holding the date and time stored in @value.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_from_value (const GDateTimeValue *value) /* IN */
+{
+  GDateTime *dt;
+
+  g_return_val_if_fail (value != NULL, NULL);
+
+  dt = g_date_time_new ();
+  g_date_time_copy_value (dt, value);
+
+  return dt;
+}
+
+/**
+ * g_date_time_new_full:
+ * @year: the gregorian year
+ * @month: the gregorian month
+ * @day: the day of the gregorian month
+ * @hour: the hour of the day
+ * @minute: the minute of the hour
+ * @second: the second of the minute
+ *
+ * Creates a new #GDateTime using the date and times in the gregorian calendar.
+ *
+ * Return value: the newly created #GDateTime
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_full (gint year,   /* IN */
+                      gint month,  /* IN */
+                      gint day,    /* IN */
+                      gint hour,   /* IN */
+                      gint minute, /* IN */
+                      gint second) /* IN */
+{
+  GDateTime *dt;
+
+  if ((dt = g_date_time_new_full_with_zone (NULL, year, month, day,
+                                            hour, minute, second)))
+    g_date_time_set_local (dt);
+
+  return dt;
+}
+
+/**
+ * g_date_time_new_full_with_resolve:
+ * @tz: a #GTimeZone
+ * @resolve: how to handle wall clock times that are repeated or skipped
+ * @year: the gregorian year
+ * @month: the gregorian month
+ * @day: the day of the gregorian month
+ * @hour: the hour of the day
+ * @minute: the minute of the hour
+ * @second: the second of the minute
+ *
+ * Like g_date_time_new_full_with_zone(), but uses @resolve to choose an
+ * instant when the wall clock time is repeated or skipped in @tz.  Skipped
+ * wall clock times are moved to the wall clock time of the chosen instant.
+ *
+ * Return value: the newly created #GDateTime, or %NULL if @resolve is
+ *   %G_TIME_RESOLVE_REJECT and the wall clock time is repeated or skipped.
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_full_with_resolve (GTimeZone    *tz,      /* IN */
+                                   GTimeResolve  resolve, /* IN */
+                                   gint          year,    /* IN */
+                                   gint          month,   /* IN */
+                                   gint          day,     /* IN */
+                                   gint          hour,    /* IN */
+                                   gint          minute,  /* IN */
+                                   gint          second)  /* IN */
+{
+  GDateTime *dt;
+  gint64     local,
+             utc;
+  gint       julian;
+
+  g_return_val_if_fail (tz != NULL, NULL);
+
+  if (!(dt = g_date_time_new_full_with_zone (tz, year, month, day,
+                                             hour, minute, second)))
+    return NULL;
+
+  /* Leap seconds are never repeated or skipped */
+  if (G_UNLIKELY (dt->leap))
+    return dt;
+
+  TO_JULIAN (year, month, day, &julian);
+  local = (julian - UNIX_EPOCH_JULIAN) * SEC_PER_DAY
+        + hour * 3600 + minute * 60 + second;
+
+  if (!g_time_zone_resolve_local (tz, local, resolve, &utc))
+    {
+      g_date_time_unref (dt);
+      return NULL;
+    }
+
+  g_date_time_init_from_epoch (dt, utc, 0);
+
+  return dt;
+}
+
+/**
+ * g_date_time_new_full_with_zone:
+ * @tz: a #GTimeZone, or %NULL for UTC
+ * @year: the gregorian year
+ * @month: the gregorian month
+ * @day: the day of the gregorian month
+ * @hour: the hour of the day
+ * @minute: the minute of the hour
+ * @second: the second of the minute
+ *
+ * Creates a new #GDateTime using the wall clock time in @tz given by the
+ * date and times in the gregorian calendar.
+ *
+ * Return value: the newly created #GDateTime
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_new_full_with_zone (GTimeZone *tz,     /* IN */
+                                gint       year,   /* IN */
+                                gint       month,  /* IN */
+                                gint       day,    /* IN */
+                                gint       hour,   /* IN */
+                                gint       minute, /* IN */
+                                gint       second) /* IN */
+{
+  GDateTime *dt;
+
+  dt = g_date_time_new ();
+  g_date_time_store_zone (dt, tz);
+
+  if (!g_date_time_init_full (dt, year, month, day, hour, minute, second))
+    {
+      g_date_time_free (dt);
+      return NULL;
+    }
+
+  return dt;
+}
+
+/**
+ * g_date_time_now:
+ *
+ * Creates a new #GDateTime representing the current date and time.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_now (void)
+{
+  GTimeVal tv;
+  g_get_current_time (&tv);
+  return g_date_time_new_from_timeval (&tv);
+}
+
+/**
+ * g_date_time_parse:
+ * @input: the string to parse
+ *
+ * Parses @input using a the set of known formats for date and times.  The
+ * parsed date and time is stored in a new #GDateTime and returned.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref() or %NULL upon error.
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_parse (const gchar *input) /* IN */
+{
+  /* TODO: Implement parsing with locale support */
+  g_warn_if_reached ();
+  return NULL;
+}
+
+/*
+ * Parses a numeric offset from UTC such as "+0530", "+05:30", "-08" or "Z"
+ * at the start of @input into @offset, returning the length parsed or 0.
+ */
+static gint
+g_date_time_parse_offset (const gchar *input,
+                          gint32      *offset)
+{
+  const gchar *p = input;
+  gint         sign,
+               hours,
+               minutes = 0;
+
+  if (*p == 'Z')
+    {
+      *offset = 0;
+      return 1;
+    }
+
+  if (*p != '+' && *p != '-')
+    return 0;
+
+  sign = (*p++ == '-') ? -1 : 1;
+
+  if (!g_ascii_isdigit (p [0]) || !g_ascii_isdigit (p [1]))
+    return 0;
+
+  hours = (p [0] - '0') * 10 + (p [1] - '0');
+  p += 2;
+
+  if (p [0] == ':' && g_ascii_isdigit (p [1]) && g_ascii_isdigit (p [2]))
+    p++;
+
+  if (g_ascii_isdigit (p [0]) && g_ascii_isdigit (p [1]))
+    {
+      minutes = (p [0] - '0') * 10 + (p [1] - '0');
+      p += 2;
+    }
+
+  if (hours > 24 || minutes > 59)
+    return 0;
+
+  *offset = sign * ((hours * 3600) + (minutes * 60));
+
+  return p - input;
+}
+
+/*
+ * Parses a timezone abbreviation such as "PST" at the start of @input into
+ * @offset, returning the length parsed or 0 if it is not known.
+ */
+static gint
+g_date_time_parse_abbreviation (const gchar *input,
+                                gint32      *offset)
+{
+  const GTzAbbr *abbr;
+  gint           len;
+
+  for (len = 0; g_ascii_isalpha (input [len]); len++)
+    if (len == 5)
+      return 0;
+
+  if (len == 0)
+    return 0;
+
+  abbr = &tz_abbrs [g_tz_abbr_hash (input, len)];
+  if (!abbr->abbr || strncmp (abbr->abbr, input, len) != 0 ||
+      abbr->abbr [len] != '\0')
+    return 0;
+
+  *offset = abbr->offset;
+
+  return len;
+}
+
+/**
+ * g_date_time_parse_with_format:
+ * @format: the format string
+ * @input: the string to parse
+ *
+ * Parses @input using the @format specified.  The parsed date and time is
+ * stored in a new #GDateTime and returned.
+ *
+ * The following format specifiers are supported:
+ *
+ * %%d  The day ranging from 1 to 31.
+ * %%H  The hour ranging from 1 to 23.
+ * %%I  The hour ranging from 1 to 12. Best used with %%p or %%P.
+ * %%m  The month ranging from 1 to 12.
+ * %%M  The minute ranging from 1 to 59.
+ * %%p  The AM/PM specifier.
+ * %%P  The am/pm specifier.
+ * %%S  The second ranging from 1 to 60.
+ * %%t  A literal tab (\t).
+ * %%y  The 2-decimal representation of the year.
+ * %%Y  The year.
+ * %%z  The offset from UTC such as "+0530", "+05:30", "-08" or "Z".
+ * %%Z  The timezone abbreviation such as "PST" or "CEST".  Abbreviations
+ *      naming several offsets, such as "IST", are not accepted.
+ *
+ * With %%z or %%Z the result is in a timezone with that fixed offset from
+ * UTC, and otherwise in the local timezone.  Unknown specifiers are an
+ * error.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref() or %NULL upon error.
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_parse_with_format (const gchar *format, /* IN */
+                               const gchar *input)  /* IN */
+{
+  gint       year    = 1,
+             month   = 1,
+             day     = 1,
+             hour    = 0,
+             minute  = 0,
+             second  = 0,
+             utf8len,
+             len,
+             i;
+  gint32     offset  = 0;
+  gboolean   in_mod   = FALSE,
+             has_ampm = FALSE,
+             has_zone = FALSE,
+             is_pm    = FALSE;
+  gchar     *tmpf,
+             buffer [64],
+             c;
+  GTimeZone *tz;
+  GDateTime *dt;
+
+  g_return_val_if_fail (format != NULL, NULL);
+  g_return_val_if_fail (g_utf8_validate (format, -1, NULL), NULL);
+  g_return_val_if_fail (input != NULL, NULL);
+  g_return_val_if_fail (g_utf8_validate (input, -1, NULL), NULL);
+
+  utf8len = g_utf8_strlen (format, -1);
+  memset (buffer, 0, sizeof (buffer));
+
+  #define HANDLE_INT(p,w,o) G_STMT_START {                                  \
+    memset (buffer, 0, sizeof (buffer));                                    \
+    memcpy (buffer, (p), (w));                                              \
+    *(o) = atoi (buffer);                                                   \
+    input += (w);                                                           \
+  } G_STMT_END
+
+  for (i = 0; i < utf8len; i++)
+    {
+      tmpf = g_utf8_offset_to_pointer (format, i);
+      c = g_utf8_get_char (tmpf);
+
+      if (!in_mod)
+        {
+          if (c == '%')
+            in_mod = TRUE;
+          else
+            {
+              if (tmpf [0] != input [0])
+                goto bad_format;
+              input++;
+            }
+        }
+      else
+        {
+          switch (c) {
+          case '%':
+            if (input [0] != '%')
+              goto bad_format;
+            input++;
+            break;
+          case 'd':
+            HANDLE_INT (input, 2, &day);
+            break;
+          case 'H':
+            HANDLE_INT (input, 2, &hour);
+            break;
+          case 'I':
+            HANDLE_INT (input, 2, &hour);
+            break;
+          case 'M':
+            HANDLE_INT (input, 2, &minute);
+            break;
+          case 'm':
+            HANDLE_INT (input, 2, &month);
+            break;
+          case 'p':
+            has_ampm = TRUE;
+            if (g_str_has_prefix (input, "PM"))
+              is_pm = TRUE;
+            else if (g_str_has_prefix (input, "AM"))
+              is_pm = FALSE;
+            else
+              goto bad_format;
+            input += 2;
+            break;
+          case 'P':
+            has_ampm = TRUE;
+            if (g_str_has_prefix (input, "pm"))
+              is_pm = TRUE;
+            else if (g_str_has_prefix (input, "am"))
+              is_pm = FALSE;
+            else
+              goto bad_format;
+            input += 2;
+            break;
+          case 'S':
+            HANDLE_INT (input, 2, &second);
+            break;
+          case 't':
+            if (input [0] != '\t')
+              goto bad_format;
+            input++;
+            break;
+          case 'y':
+            HANDLE_INT (input, 2, &year);
+            if (year > 70)
+              year += 1900;
+            else
+              year += 2000;
+            break;
+          case 'Y':
+            HANDLE_INT (input, 4, &year);
+            break;
+          case 'z':
+            if (!(len = g_date_time_parse_offset (input, &offset)))
+              goto bad_format;
+            has_zone = TRUE;
+            input += len;
+            break;
+          case 'Z':
+            if (!(len = g_date_time_parse_abbreviation (input, &offset)))
+              goto bad_format;
+            has_zone = TRUE;
+            input += len;
+            break;
+          default:
+            goto bad_format;
+          }
+
+          in_mod = FALSE;
+        }
+    }
+
+  #undef HANDLE_INT
+
+  if (month < 1 || month > 12)
+    goto bad_value;
+  else if (day < 1 || day > 31)
+    goto bad_value;
+  else if (hour < 0 || hour > 23)
+    goto bad_value;
+  else if (minute < 0 || minute > 59)
+    goto bad_value;
+  else if (second < 0 || second > 60)
+    goto bad_value;
+
+  if (has_ampm)
+    {
+      if (!is_pm && hour == 12)
+        hour = 0;
+      else if (is_pm && hour < 12)
+        hour += 12;
+    }
+
+  if (!has_zone)
+    return g_date_time_new_full (year, month, day, hour, minute, second);
+
+  /* Fixed offsets are registered like any other zone, see g_time_zone_new() */
+  if (offset == 0)
+    tz = g_time_zone_new_utc ();
+  else
+    {
+      g_snprintf (buffer, sizeof (buffer), "%c%02d:%02d",
+                  offset < 0 ? '-' : '+',
+                  ABS (offset) / 3600, ABS (offset) / 60 % 60);
+      tz = g_time_zone_new (buffer);
+    }
+
+  dt = g_date_time_new_full_with_zone (tz, year, month, day,
+                                       hour, minute, second);
+  g_time_zone_unref (tz);
+
+  return dt;
+
+bad_format:
+#if 0
+  g_debug ("Bad Format: Expected \"%s\", got \"%s\"", tmpf, input);
+#endif
+  return NULL;
+
+bad_value:
+#if 0
+  g_debug ("Bad Value: Year=%d, Month=%d, Day=%d, Hour=%d, Minute=%d, Second=%d",
+           year, month, day, hour, minute, second);
+#endif
+  return NULL;
+}
+
+/**
+ * g_date_time_printf:
+ * @datetime: A #GDateTime
+ * @format: a format string for the #GDateTime
+ *
+ * Creates a newly allocated string representing the format requested by
+ * @format.
+ *
+ * The following format specifiers are supported:
+ *
+ * %%a  The abbreviated weekday name according to the current locale.
+ * %%A  The full weekday name according to the current locale.
+ * %%b  The abbreviated month name according to the current locale.
+ * %%B  The full month name according to the current locale.
+ * %%d  The day of the month as a decimal number (range 01 to 31).
+ * %%e  The day of the month as a decimal number (range  1 to 31).
+ * %%F  Equivalent to %Y-%m-%d (the ISO 8601 date format).
+ * %%h  Equivalent to %b.
+ * %%H  The hour as a decimal number using a 24-hour clock (range 00 to 23).
+ * %%I  The hour as a decimal number using a 12-hour clock (range 01 to 12).
+ * %%j  The day of the year as a decimal number (range 001 to 366).
+ * %%k  The hour (24-hour clock) as a decimal number (range 0 to 23);
+ *      single digits are preceded by a blank.
+ * %%l  The hour (12-hour clock) as a decimal number (range 1 to 12);
+ *      single digits are preceded by a blank.
+ * %%m  The month as a decimal number (range 01 to 12).
+ * %%M  The minute as a decimal number (range 00 to 59).
+ * %%N  The micro-seconds as a decimal number.
+ * %%p  Either "AM" or "PM" according to the given time  value, or the
+ *      corresponding  strings  for the current locale.  Noon is treated
+ *      as "PM" and midnight as "AM".
+ * %%P  Like %%p but lowercase: "am" or "pm" or a corresponding string for
+ *      the current locale.
+ * %%r  The time in a.m. or p.m. notation.
+ * %%R  The time in 24-hour notation (%H:%M).
+ * %%s  The number of seconds since the Epoch, that is, since 1970-01-01
+ *      00:00:00 UTC.
+ * %%S  The second as a decimal number (range 00 to 60).
+ * %%t  A tab character.
+ * %%u  The day of the week as a decimal, range 1 to 7, Monday being 1.
+ * %%W  The week number of the current year as a decimal number.
+ * %%x  The preferred date representation for the current locale without
+ *      the date.
+ * %%X  The preferred date representation for the current locale without
+ *      the time.
+ * %%y  The year as a decimal number without the century.
+ * %%Y  The year as a decimal number including the century.
+ * %%z  The timezone or name or abbreviation.
+ * %%%  A literal %% character.
+ *
+ * Return value: a newly allocated string formatted to the requested format or
+ *   %NULL in the case that there was an error.  The string should be freed
+ *   with g_free().
+ *
+ * Since: 2.26
+ */
+gchar*
+g_date_time_printf (GDateTime   *datetime, /* IN */
+                    const gchar *format)   /* IN */
+{
+  GString     *outstr;
+  GTimeZone   *tz;
+  const gchar *tmp;
+  gchar       *tmp2,
+               c;
+  glong        utf8len;
+  gint         i;
+  gboolean     in_mod;
+  
+  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (format != NULL, NULL);
+  g_return_val_if_fail (g_utf8_validate (format, -1, NULL), NULL);
+  
+  outstr = g_string_sized_new (strlen (format) * 2);
+  utf8len = g_utf8_strlen (format, -1);
+  in_mod = FALSE;
+  
+  for (i = 0; i < utf8len; i++)
+    {
+      tmp = g_utf8_offset_to_pointer (format, i);
+      c = g_utf8_get_char (tmp);
+
+      switch (c) {
+      case '%':
+        if (!in_mod)
           {
             in_mod = TRUE;
             break;
@@ -1910,8 +2793,9 @@ g_date_time_printf (GDateTime   *datetime, /* IN */
                                       g_date_time_get_minute (datetime));
               break;
             case 'N':
-              g_string_append_printf (outstr, "%"G_GUINT64_FORMAT,
-                                      datetime->usec % USEC_PER_SECOND);
+              g_string_append_printf (outstr, "%"G_GINT64_FORMAT,
+                                      g_date_time_get_day_usec (datetime)
+                                      % USEC_PER_SECOND);
               break;
             case 'p':
               g_string_append (outstr, GET_AMPM (datetime, FALSE));
@@ -1975,10 +2859,10 @@ g_date_time_printf (GDateTime   *datetime, /* IN */
                                       g_date_time_get_year (datetime));
               break;
             case 'z':
-              if (g_date_time_is_daylight_savings (datetime))
-                g_string_append_printf (outstr, "%s", datetime->tz->dst_name);
-              else if (datetime->tz)
-                g_string_append_printf (outstr, "%s", datetime->tz->std_name);
+              if ((tz = g_date_time_get_zone (datetime)))
+                g_string_append (outstr,
+                  g_time_zone_get_abbreviation (tz,
+                    g_date_time_get_interval (datetime, tz)));
               else
                 g_string_append_printf (outstr, "UTC");
               break;
@@ -1998,229 +2882,1044 @@ g_date_time_printf (GDateTime   *datetime, /* IN */
       }
   }
 
-  tmp = outstr->str;
-  g_string_free (outstr, FALSE);
+  tmp = outstr->str;
+  g_string_free (outstr, FALSE);
+
+  return (gchar*)tmp;
+
+bad_format:
+  g_string_free (outstr, TRUE);
+  return NULL;
+}
+
+/**
+ * g_date_time_ref:
+ * @datetime: a #GDateTime
+ *
+ * Atomically increments the reference count of @datetime by one.  This
+ * does nothing if @datetime was allocated from a #GDateTimeArena.
+ *
+ * Return value: the reference @datetime
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_ref (GDateTime *datetime) /* IN */
+{
+  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (datetime->ref_count > 0, NULL);
+  if (!datetime->arena)
+    g_atomic_int_inc (&datetime->ref_count);
+  return datetime;
+}
+
+/**
+ * g_date_time_to_gps:
+ * @datetime: a #GDateTime
+ *
+ * Converts @datetime to GPS time, which counts leap seconds from
+ * 1980-01-06 00:00:00 UTC.  Any fraction of a second is discarded.
+ *
+ * Return value: the seconds of GPS time since 1980-01-06 00:00:00 UTC
+ *
+ * Since: 2.26
+ */
+gint64
+g_date_time_to_gps (GDateTime *datetime) /* IN */
+{
+  gint64 usec;
+
+  g_return_val_if_fail (datetime != NULL, 0);
+
+  return g_date_time_get_tai (datetime, &usec) - GPS_EPOCH_TAI;
+}
+
+/**
+ * g_date_time_to_local:
+ * @datetime: a #GDateTime
+ *
+ * Creates a new #GDateTime with @datetime converted to local time, which is
+ * in the timezone pushed with g_time_zone_push_thread_default() if any.
+ *
+ * Return value: the newly created #GDateTime
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_to_local (GDateTime *datetime) /* IN */
+{
+  GDateTime *dt;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  dt = g_date_time_copy (datetime);
+  g_date_time_store_local (dt);
+
+  return dt;
+}
+
+/**
+ * g_date_time_to_tai:
+ * @datetime: a #GDateTime
+ *
+ * Converts @datetime to International Atomic Time (TAI).  The result is
+ * the time since the Epoch in seconds as for g_date_time_to_time_t(), plus
+ * the offset of TAI from UTC returned by g_time_zone_get_tai_offset(), so
+ * it grows by two across a leap second.  Any fraction of a second is
+ * discarded.
+ *
+ * Return value: the seconds of TAI since the Epoch
+ *
+ * Since: 2.26
+ */
+gint64
+g_date_time_to_tai (GDateTime *datetime) /* IN */
+{
+  gint64 usec;
+
+  g_return_val_if_fail (datetime != NULL, 0);
+
+  return g_date_time_get_tai (datetime, &usec);
+}
+
+/**
+ * g_date_time_to_time_t:
+ * @datetime: a #GDateTime
+ *
+ * Converts @datetime into a #time_t
+ *
+ * Return value: @datetime as a #time_t
+ *
+ * Since: 2.26
+ */
+time_t
+g_date_time_to_time_t (GDateTime *datetime) /* IN */
+{
+  gint year;
+
+  g_return_val_if_fail (datetime != NULL, (time_t)0);
+
+  year = g_date_time_get_year (datetime);
+
+  if (year < 1970)
+    return (time_t)0;
+  else if (year > 2037)
+    return (time_t)G_MAXINT;
+
+  return (time_t)g_date_time_get_epoch_seconds (datetime);
+}
+
+/**
+ * g_date_time_to_timeval:
+ * @datetime: a #GDateTime
+ * @tv: A #GTimeVal
+ *
+ * Converts @datetime into a #GTimeVal and stores the result into @timeval.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_to_timeval (GDateTime *datetime, /* IN */
+                        GTimeVal  *tv)       /* OUT */
+{
+  g_return_if_fail (datetime != NULL);
+
+  tv->tv_sec = g_date_time_to_time_t (datetime);
+  tv->tv_usec = g_date_time_get_day_usec (datetime) % USEC_PER_SECOND;
+}
+
+/**
+ * g_date_time_to_utc:
+ * @datetime: a #GDateTime
+ *
+ * Creates a new #GDateTime that reprents @datetime in Universal coordinated
+ * time.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_to_utc (GDateTime *datetime) /* IN */
+{
+  GDateTime *dt;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  dt = g_date_time_copy (datetime);
+  g_date_time_set_zone (dt, NULL);
+
+  return dt;
+}
+
+/**
+ * g_date_time_to_zone:
+ * @datetime: a #GDateTime
+ * @tz: a #GTimeZone, or %NULL for UTC
+ *
+ * Creates a new #GDateTime that represents the same instant as @datetime
+ * as a wall clock time in @tz.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_to_zone (GDateTime *datetime, /* IN */
+                     GTimeZone *tz)       /* IN */
+{
+  GDateTime *dt;
+
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  dt = g_date_time_copy (datetime);
+  g_date_time_set_zone (dt, tz);
+
+  return dt;
+}
+
+/**
+ * g_date_time_today:
+ *
+ * Createsa new #GDateTime that represents Midnight on the current day.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_today (void)
+{
+  GDateTime *dt;
+
+  dt = g_date_time_now ();
+  g_date_time_set_wall (dt, g_date_time_get_julian_day (dt) * USEC_PER_DAY,
+                        FALSE);
+
+  return dt;
+}
+
+/**
+ * g_date_time_unref:
+ * @datetime: a #GDateTime
+ *
+ * Atomically decrements the reference count of @datetime by one.  When the
+ * reference count reaches zero, the structure is freed.  This does nothing
+ * if @datetime was allocated from a #GDateTimeArena, which frees it instead.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_unref (GDateTime *datetime) /* IN */
+{
+  g_return_if_fail (datetime != NULL);
+  g_return_if_fail (datetime->ref_count > 0);
+
+  if (datetime->arena)
+    return;
+
+  if (g_atomic_int_dec_and_test (&datetime->ref_count))
+    g_date_time_free (datetime);
+}
+
+/**
+ * g_date_time_utc_now:
+ *
+ * Creates a new #GDateTime that represents the current instant at Universal
+ * coordinated time.
+ *
+ * Return value: the newly created #GDateTime which should be freed with
+ *   g_date_time_unref().
+ *
+ * Since: 2.26
+ */
+GDateTime*
+g_date_time_utc_now (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+
+  return g_date_time_new_from_epoch (NULL, tv.tv_sec, tv.tv_usec);
+}
+
+/**
+ * g_date_time_value_add:
+ * @value: a #GDateTimeValue
+ * @timespan: a #GTimeSpan
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus @timespan in @result, like g_date_time_add().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add (const GDateTimeValue *value,    /* IN */
+                       GTimeSpan             timespan, /* IN */
+                       GDateTimeValue       *result)   /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  ADD_USEC ((&dt), timespan);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_days:
+ * @value: a #GDateTimeValue
+ * @days: the number of days
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of days in @result, like
+ * g_date_time_add_days().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_days (const GDateTimeValue *value,  /* IN */
+                            gint                  days,   /* IN */
+                            GDateTimeValue       *result) /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  g_date_time_shift_days (&dt, days);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_full:
+ * @value: a #GDateTimeValue
+ * @years: the number of years to add
+ * @months: the number of months to add
+ * @days: the number of days to add
+ * @hours: the number of hours to add
+ * @minutes: the number of minutes to add
+ * @seconds: the number of seconds to add
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified values in @result, like
+ * g_date_time_add_full().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_full (const GDateTimeValue *value,   /* IN */
+                            gint                  years,   /* IN */
+                            gint                  months,  /* IN */
+                            gint                  days,    /* IN */
+                            gint                  hours,   /* IN */
+                            gint                  minutes, /* IN */
+                            gint                  seconds, /* IN */
+                            GDateTimeValue       *result)  /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  g_date_time_shift_years (&dt, years);
+  g_date_time_shift_months (&dt, months);
+  g_date_time_shift_days (&dt, days);
+  ADD_USEC ((&dt), hours * USEC_PER_HOUR
+                 + minutes * USEC_PER_MINUTE
+                 + seconds * USEC_PER_SECOND);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_hours:
+ * @value: a #GDateTimeValue
+ * @hours: the number of hours
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of hours in @result, like
+ * g_date_time_add_hours().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_hours (const GDateTimeValue *value,  /* IN */
+                             gint                  hours,  /* IN */
+                             GDateTimeValue       *result) /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  ADD_USEC ((&dt), hours * USEC_PER_HOUR);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_milliseconds:
+ * @value: a #GDateTimeValue
+ * @milliseconds: the number of milliseconds
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of milliseconds in @result, like
+ * g_date_time_add_milliseconds().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_milliseconds (const GDateTimeValue *value,        /* IN */
+                                    gint                  milliseconds, /* IN */
+                                    GDateTimeValue       *result)       /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  ADD_USEC ((&dt), milliseconds * USEC_PER_MILLISECOND);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_minutes:
+ * @value: a #GDateTimeValue
+ * @minutes: the number of minutes
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of minutes in @result, like
+ * g_date_time_add_minutes().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_minutes (const GDateTimeValue *value,   /* IN */
+                               gint                  minutes, /* IN */
+                               GDateTimeValue       *result)  /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  ADD_USEC ((&dt), minutes * USEC_PER_MINUTE);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_months:
+ * @value: a #GDateTimeValue
+ * @months: the number of months
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of months in @result, like
+ * g_date_time_add_months().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_months (const GDateTimeValue *value,  /* IN */
+                              gint                  months, /* IN */
+                              GDateTimeValue       *result) /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  g_date_time_shift_months (&dt, months);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_seconds:
+ * @value: a #GDateTimeValue
+ * @seconds: the number of seconds
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of seconds in @result, like
+ * g_date_time_add_seconds().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_seconds (const GDateTimeValue *value,   /* IN */
+                               gint                  seconds, /* IN */
+                               GDateTimeValue       *result)  /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  ADD_USEC ((&dt), seconds * USEC_PER_SECOND);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_add_weeks:
+ * @value: a #GDateTimeValue
+ * @weeks: the number of weeks
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of weeks in @result, like
+ * g_date_time_add_weeks().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_weeks (const GDateTimeValue *value,  /* IN */
+                             gint                  weeks,  /* IN */
+                             GDateTimeValue       *result) /* OUT */
+{
+  g_date_time_value_add_days (value, weeks * 7, result);
+}
+
+/**
+ * g_date_time_value_add_years:
+ * @value: a #GDateTimeValue
+ * @years: the number of years
+ * @result: a location for the result, which may be @value
+ *
+ * Stores @value plus the specified number of years in @result, like
+ * g_date_time_add_years().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_add_years (const GDateTimeValue *value,  /* IN */
+                             gint                  years,  /* IN */
+                             GDateTimeValue       *result) /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_date_time_load_value (&dt, value);
+  g_date_time_shift_years (&dt, years);
+  g_date_time_get_value (&dt, result);
+}
+
+/**
+ * g_date_time_value_compare:
+ * @v1: first #GDateTimeValue to compare
+ * @v2: second #GDateTimeValue to compare
+ *
+ * qsort()-style comparison for arrays of #GDateTimeValue, like
+ * g_date_time_compare().
+ *
+ * Return value: 0 for equal, less than zero if @v1 is less than @v2, greater
+ *   than zero if @v1 is greater than @v2.
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_value_compare (gconstpointer v1, /* IN */
+                           gconstpointer v2) /* IN */
+{
+  const GDateTimeValue *a = v1,
+                       *b = v2;
+
+  if (a->usec != b->usec)
+    return a->usec > b->usec ? 1 : -1;
+
+  return (gint)b->leap - (gint)a->leap;
+}
+
+/**
+ * g_date_time_value_equal:
+ * @v1: a #GDateTimeValue
+ * @v2: a #GDateTimeValue
+ *
+ * Checks to see if @v1 and @v2 are equal, like g_date_time_equal().
+ *
+ * Return value: %TRUE if @v1 and @v2 are equal
+ *
+ * Since: 2.26
+ */
+gboolean
+g_date_time_value_equal (gconstpointer v1, /* IN */
+                         gconstpointer v2) /* IN */
+{
+  const GDateTimeValue *a = v1,
+                       *b = v2;
 
-  return (gchar*)tmp;
+  return a->usec == b->usec && a->leap == b->leap;
+}
 
-bad_format:
-  g_string_free (outstr, TRUE);
-  return NULL;
+/**
+ * g_date_time_value_get_day_of_month:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_get_day_of_month(), but for a #GDateTimeValue.
+ *
+ * Return value: the day of the month
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_value_get_day_of_month (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, 0);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_day_of_month (&dt);
 }
 
 /**
- * g_date_time_ref:
- * @datetime: a #GDateTime
+ * g_date_time_value_get_day_of_week:
+ * @value: a #GDateTimeValue
  *
- * Atomically increments the reference count of @datetime by one.
+ * Like g_date_time_get_day_of_week(), but for a #GDateTimeValue.
  *
- * Return value: the reference @datetime
+ * Return value: the day of the week
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_ref (GDateTime *datetime) /* IN */
+gint
+g_date_time_value_get_day_of_week (const GDateTimeValue *value) /* IN */
 {
-  g_return_val_if_fail (datetime != NULL, NULL);
-  g_return_val_if_fail (datetime->ref_count > 0, NULL);
-  g_atomic_int_inc (&datetime->ref_count);
-  return datetime;
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, 0);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_day_of_week (&dt);
 }
 
 /**
- * g_date_time_to_local:
- * @datetime: a #GDateTime
+ * g_date_time_value_get_day_of_year:
+ * @value: a #GDateTimeValue
  *
- * Creates a new #GDateTime with @datetime converted to local time.
+ * Like g_date_time_get_day_of_year(), but for a #GDateTimeValue.
  *
- * Return value: the newly created #GDateTime
+ * Return value: the day of the year
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_to_local (GDateTime *datetime) /* IN */
+gint
+g_date_time_value_get_day_of_year (const GDateTimeValue *value) /* IN */
 {
-  GDateTime *dt;
-  gint       offset,
-             year;
-  gint64     usec;
+  GDateTime dt;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (value != NULL, 0);
 
-  dt = g_date_time_copy (datetime);
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_day_of_year (&dt);
+}
 
-  if (!dt->tz)
-    {
-      year = g_date_time_get_year (dt);
-      dt->tz = g_time_zone_new_from_year (year);
+/**
+ * g_date_time_value_get_dmy:
+ * @value: a #GDateTimeValue
+ * @day: a location for the day of the month, or %NULL
+ * @month: a location for the month of the year, or %NULL
+ * @year: a location for the gregorian year, or %NULL
+ *
+ * Like g_date_time_get_dmy(), but for a #GDateTimeValue.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_get_dmy (const GDateTimeValue *value, /* IN */
+                           gint                 *day,   /* OUT */
+                           gint                 *month, /* OUT */
+                           gint                 *year)  /* OUT */
+{
+  GDateTime dt;
 
-      if (g_date_time_is_daylight_savings (dt))
-        offset = dt->tz->std_gmtoff + dt->tz->dst_gmtoff;
-      else
-        offset =  dt->tz->std_gmtoff;
+  g_return_if_fail (value != NULL);
 
-      usec = offset * USEC_PER_SECOND;
-      ADD_USEC (dt, usec);
-    }
+  g_date_time_load_value (&dt, value);
+  g_date_time_get_dmy (&dt, day, month, year);
+}
 
-  return dt;
+/**
+ * g_date_time_value_get_hour:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_get_hour(), but for a #GDateTimeValue.
+ *
+ * Return value: the hour of the day
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_value_get_hour (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, 0);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_hour (&dt);
 }
 
 /**
- * g_date_time_to_time_t:
- * @datetime: a #GDateTime
+ * g_date_time_value_get_microsecond:
+ * @value: a #GDateTimeValue
  *
- * Converts @datetime into a #time_t
+ * Like g_date_time_get_microsecond(), but for a #GDateTimeValue.
  *
- * Return value: @datetime as a #time_t
+ * Return value: the microsecond of the second
  *
  * Since: 2.26
  */
-time_t
-g_date_time_to_time_t (GDateTime *datetime) /* IN */
+gint
+g_date_time_value_get_microsecond (const GDateTimeValue *value) /* IN */
 {
-  struct tm tm;
-  gint      year,
-            month,
-            day;
+  GDateTime dt;
 
-  g_return_val_if_fail (datetime != NULL, (time_t)0);
-  g_return_val_if_fail (datetime->period == 0, (time_t)0);
+  g_return_val_if_fail (value != NULL, 0);
 
-  g_date_time_get_dmy (datetime, &day, &month, &year);
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_microsecond (&dt);
+}
 
-  if (year < 1970)
-    return (time_t)0;
-  else if (year > 2037)
-    return (time_t)G_MAXINT;
+/**
+ * g_date_time_value_get_millisecond:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_get_millisecond(), but for a #GDateTimeValue.
+ *
+ * Return value: the millisecond of the second
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_value_get_millisecond (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, 0);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_millisecond (&dt);
+}
 
-  memset (&tm, 0, sizeof (tm));
+/**
+ * g_date_time_value_get_minute:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_get_minute(), but for a #GDateTimeValue.
+ *
+ * Return value: the minute of the hour
+ *
+ * Since: 2.26
+ */
+gint
+g_date_time_value_get_minute (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
 
-  tm.tm_year = year - 1900;
-  tm.tm_mon = month - 1;
-  tm.tm_mday = day;
-  tm.tm_hour = g_date_time_get_hour (datetime);
-  tm.tm_min = g_date_time_get_minute (datetime);
-  tm.tm_sec = g_date_time_get_second (datetime);
-  tm.tm_isdst = -1;
+  g_return_val_if_fail (value != NULL, 0);
 
-  return mktime (&tm);
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_minute (&dt);
 }
 
 /**
- * g_date_time_to_timeval:
- * @datetime: a #GDateTime
- * @tv: A #GTimeVal
+ * g_date_time_value_get_month:
+ * @value: a #GDateTimeValue
  *
- * Converts @datetime into a #GTimeVal and stores the result into @timeval.
+ * Like g_date_time_get_month(), but for a #GDateTimeValue.
+ *
+ * Return value: the month of the year
  *
  * Since: 2.26
  */
-void
-g_date_time_to_timeval (GDateTime *datetime, /* IN */
-                        GTimeVal  *tv)       /* OUT */
+gint
+g_date_time_value_get_month (const GDateTimeValue *value) /* IN */
 {
-  g_return_if_fail (datetime != NULL);
+  GDateTime dt;
 
-  tv->tv_sec = 0;
-  tv->tv_usec = 0;
+  g_return_val_if_fail (value != NULL, 0);
 
-  if (G_LIKELY (datetime->period == 0))
-    {
-      tv->tv_sec = g_date_time_to_time_t (datetime);
-      tv->tv_usec = datetime->usec % USEC_PER_SECOND;
-    }
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_month (&dt);
 }
 
 /**
- * g_date_time_to_utc:
- * @datetime: a #GDateTime
+ * g_date_time_value_get_second:
+ * @value: a #GDateTimeValue
  *
- * Creates a new #GDateTime that reprents @datetime in Universal coordinated
- * time.
+ * Like g_date_time_get_second(), but for a #GDateTimeValue.
  *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
+ * Return value: the second of the minute
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_to_utc (GDateTime *datetime) /* IN */
+gint
+g_date_time_value_get_second (const GDateTimeValue *value) /* IN */
 {
-  GDateTime *dt;
-  GTimeSpan  ts;
+  GDateTime dt;
 
-  g_return_val_if_fail (datetime != NULL, NULL);
+  g_return_val_if_fail (value != NULL, 0);
 
-  g_date_time_get_utc_offset (datetime, &ts);
-  ts = -ts;
-  dt = g_date_time_add (datetime, &ts);
-  dt->tz = NULL;
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_second (&dt);
+}
 
-  return dt;
+/**
+ * g_date_time_value_get_utc_offset:
+ * @value: a #GDateTimeValue
+ * @timespan: a #GTimeSpan
+ *
+ * Like g_date_time_get_utc_offset(), but for a #GDateTimeValue.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_get_utc_offset (const GDateTimeValue *value,    /* IN */
+                                  GTimeSpan            *timespan) /* OUT */
+{
+  GDateTime dt;
+
+  g_return_if_fail (value != NULL);
+
+  g_date_time_load_value (&dt, value);
+  g_date_time_get_utc_offset (&dt, timespan);
 }
 
 /**
- * g_date_time_today:
+ * g_date_time_value_get_year:
+ * @value: a #GDateTimeValue
  *
- * Createsa new #GDateTime that represents Midnight on the current day.
+ * Like g_date_time_get_year(), but for a #GDateTimeValue.
  *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
+ * Return value: the year of the gregorian calendar
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_today (void)
+gint
+g_date_time_value_get_year (const GDateTimeValue *value) /* IN */
 {
-  GDateTime *dt;
+  GDateTime dt;
 
-  dt = g_date_time_now ();
-  dt->usec = 0;
+  g_return_val_if_fail (value != NULL, 0);
 
-  return dt;
+  g_date_time_load_value (&dt, value);
+  return g_date_time_get_year (&dt);
 }
 
 /**
- * g_date_time_unref:
- * @datetime: a #GDateTime
+ * g_date_time_value_init_from_time_t:
+ * @value: a #GDateTimeValue
+ * @tz: a #GTimeZone, or %NULL for UTC
+ * @t: a time_t
  *
- * Atomically decrements the reference count of @datetime by one.  When the
- * reference count reaches zero, the structure is freed.
+ * Stores the instant @t seconds after the Epoch in @value, as a wall clock
+ * time in @tz.
  *
  * Since: 2.26
  */
 void
-g_date_time_unref (GDateTime *datetime) /* IN */
+g_date_time_value_init_from_time_t (GDateTimeValue *value, /* OUT */
+                                    GTimeZone      *tz,    /* IN */
+                                    time_t          t)     /* IN */
 {
-  g_return_if_fail (datetime != NULL);
-  g_return_if_fail (datetime->ref_count > 0);
+  GDateTime dt;
 
-  if (g_atomic_int_dec_and_test (&datetime->ref_count))
-    g_date_time_free (datetime);
+  g_return_if_fail (value != NULL);
+
+  g_date_time_init_from_epoch (&dt, t, 0);
+  g_date_time_store_zone (&dt, tz);
+  g_date_time_get_value (&dt, value);
 }
 
 /**
- * g_date_time_utc_now:
+ * g_date_time_value_init_full:
+ * @value: a #GDateTimeValue
+ * @tz: a #GTimeZone, or %NULL for UTC
+ * @year: the gregorian year
+ * @month: the gregorian month
+ * @day: the day of the gregorian month
+ * @hour: the hour of the day
+ * @minute: the minute of the hour
+ * @second: the second of the minute
  *
- * Creates a new #GDateTime that represents the current instant at Universal
- * coordinated time.
+ * Stores the wall clock time in @tz given by the date and times in the
+ * gregorian calendar in @value, like g_date_time_new_full_with_zone().
  *
- * Return value: the newly created #GDateTime which should be freed with
- *   g_date_time_unref().
+ * Return value: %TRUE if @value was set, or %FALSE if the date and time are
+ *   outside of the representable range.
  *
  * Since: 2.26
  */
-GDateTime*
-g_date_time_utc_now (void)
+gboolean
+g_date_time_value_init_full (GDateTimeValue *value,  /* OUT */
+                             GTimeZone      *tz,     /* IN */
+                             gint            year,   /* IN */
+                             gint            month,  /* IN */
+                             gint            day,    /* IN */
+                             gint            hour,   /* IN */
+                             gint            minute, /* IN */
+                             gint            second) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  dt.local = FALSE;
+  g_date_time_store_zone (&dt, tz);
+
+  if (!g_date_time_init_full (&dt, year, month, day, hour, minute, second))
+    return FALSE;
+
+  g_date_time_get_value (&dt, value);
+
+  return TRUE;
+}
+
+/**
+ * g_date_time_value_is_daylight_savings:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_is_daylight_savings(), but for a #GDateTimeValue.
+ *
+ * Return value: %TRUE if @value falls within daylight savings time.
+ *
+ * Since: 2.26
+ */
+gboolean
+g_date_time_value_is_daylight_savings (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_is_daylight_savings (&dt);
+}
+
+/**
+ * g_date_time_value_is_leap_year:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_is_leap_year(), but for a #GDateTimeValue.
+ *
+ * Return value: %TRUE if @value is in a leap year.
+ *
+ * Since: 2.26
+ */
+gboolean
+g_date_time_value_is_leap_year (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_is_leap_year (&dt);
+}
+
+/**
+ * g_date_time_value_printf:
+ * @value: a #GDateTimeValue
+ * @format: a valid UTF-8 string, containing the format for the #GDateTimeValue
+ *
+ * Like g_date_time_printf(), but for a #GDateTimeValue.
+ *
+ * Return value: a newly allocated string formatted to the requested format or
+ *   %NULL in the case that there was an error.  The string should be freed
+ *   with g_free().
+ *
+ * Since: 2.26
+ */
+gchar*
+g_date_time_value_printf (const GDateTimeValue *value,  /* IN */
+                          const gchar          *format) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, NULL);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_printf (&dt, format);
+}
+
+/**
+ * g_date_time_value_to_time_t:
+ * @value: a #GDateTimeValue
+ *
+ * Like g_date_time_to_time_t(), but for a #GDateTimeValue.
+ *
+ * Return value: @value as a #time_t
+ *
+ * Since: 2.26
+ */
+time_t
+g_date_time_value_to_time_t (const GDateTimeValue *value) /* IN */
+{
+  GDateTime dt;
+
+  g_return_val_if_fail (value != NULL, (time_t)0);
+
+  g_date_time_load_value (&dt, value);
+  return g_date_time_to_time_t (&dt);
+}
+
+/**
+ * g_date_time_value_to_zone:
+ * @value: a #GDateTimeValue
+ * @tz: a #GTimeZone, or %NULL for UTC
+ * @result: a location for the result, which may be @value
+ *
+ * Stores the same instant as @value as a wall clock time in @tz in @result,
+ * like g_date_time_to_zone().
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_value_to_zone (const GDateTimeValue *value,  /* IN */
+                           GTimeZone            *tz,     /* IN */
+                           GDateTimeValue       *result) /* OUT */
 {
-  GDateTime *utc,
-            *now;
+  GDateTime dt;
 
-  now = g_date_time_now ();
-  utc = g_date_time_to_utc (now);
-  g_date_time_unref (now);
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (result != NULL);
 
-  return utc;
+  g_date_time_load_value (&dt, value);
+  g_date_time_set_zone (&dt, tz);
+  g_date_time_get_value (&dt, result);
 }
 
+/**
+ * g_date_time_warm_up:
+ * @identifiers: a %NULL-terminated array of timezone names, or %NULL
+ *
+ * Loads the local timezone, the timezones named in @identifiers and the
+ * table of leap seconds on a background thread, so that latency sensitive
+ * threads find them ready when creating their first #GDateTime.  A thread
+ * needing a zone that is still being loaded loads it too rather than wait
+ * for the background thread.  Without thread support, the zones are loaded
+ * before returning.
+ *
+ * Since: 2.26
+ */
+void
+g_date_time_warm_up (const gchar **identifiers) /* IN */
+{
+  gchar **copy;
+
+  copy = g_strdupv ((gchar **)identifiers);
+
+  if (!g_thread_supported () ||
+      !g_thread_create (g_date_time_warm_up_func, copy, FALSE, NULL))
+    g_date_time_warm_up_func (copy);
+}
@@ -23,6 +23,8 @@
 #include <time.h>
 #include <glib.h>
 
+#include "gtimezone.h"
+
 G_BEGIN_DECLS
 
 #define G_TIME_SPAN_DAY         (G_GINT64_CONSTANT (86400000000))
@@ -31,8 +33,41 @@ G_BEGIN_DECLS
 #define G_TIME_SPAN_SECOND      (G_GINT64_CONSTANT (1000000))
 #define G_TIME_SPAN_MILLISECOND (G_GINT64_CONSTANT (1000))
 
-typedef struct _GDateTime GDateTime;
-typedef gint64            GTimeSpan;
+typedef struct _GDateTime      GDateTime;
+typedef struct _GDateTimeArena GDateTimeArena;
+typedef struct _GDateTimeValue GDateTimeValue;
+typedef gint64                 GTimeSpan;
+
+/**
+ * GDateTimeArena:
+ *
+ * An opaque structure from which each #GDateTime created by a thread may be
+ * allocated, so that they are all released together.  See
+ * g_date_time_arena_new().
+ *
+ * Since: 2.26
+ */
+
+/**
+ * GDateTimeValue:
+ *
+ * A date and time held by value, for code that cannot afford to allocate a
+ * #GDateTime at every step.  It may live on the stack or within other
+ * structures, and is copied by assignment.  Like a #GDateTime, it refers to
+ * its timezone by the index from g_time_zone_get_index(), so it holds no
+ * reference.  The fields are private and should only be accessed through
+ * the g_date_time_value_*() functions.
+ *
+ * Since: 2.26
+ */
+struct _GDateTimeValue
+{
+  /*< private >*/
+  gint64     usec;
+  guint      local   : 1;
+  guint      leap    : 1;
+  guint      zone    : 29;
+};
 
 GDateTime *   g_date_time_add                    (GDateTime      *datetime,
                                                   GTimeSpan      *timespan);
@@ -59,6 +94,10 @@ GDateTime *   g_date_time_add_weeks              (GDateTime      *datetime,
                                                   gint            weeks);
 GDateTime *   g_date_time_add_years              (GDateTime      *datetime,
                                                   gint            years);
+void          g_date_time_arena_free             (GDateTimeArena *arena);
+GDateTimeArena *g_date_time_arena_new            (void);
+void          g_date_time_arena_pop_thread_default (GDateTimeArena *arena);
+void          g_date_time_arena_push_thread_default (GDateTimeArena *arena);
 gint          g_date_time_compare                (gconstpointer   dt1,
                                                   gconstpointer   dt2);
 GDateTime *   g_date_time_copy                   (GDateTime      *datetime);
@@ -66,9 +105,14 @@ GDateTime *   g_date_time_date                   (GDateTime      *datetime);
 void          g_date_time_diff                   (GDateTime      *begin,
                                                   GDateTime      *end,
                                                   GTimeSpan      *timespan);
+void          g_date_time_diff_with_leap_seconds (GDateTime      *begin,
+                                                  GDateTime      *end,
+                                                  GTimeSpan      *timespan);
 gboolean      g_date_time_equal                  (gconstpointer   dt1,
                                                   gconstpointer   dt2);
 gchar *       g_date_time_format_for_display     (GDateTime      *datetime);
+void          g_date_time_get_allocator_stats    (guint64        *hits,
+                                                  guint64        *misses);
 gint          g_date_time_get_day_of_week        (GDateTime      *datetime);
 gint          g_date_time_get_day_of_month       (GDateTime      *datetime);
 gint          g_date_time_get_day_of_year        (GDateTime      *datetime);
@@ -90,6 +134,8 @@ gint          g_date_time_get_month              (GDateTime      *datetime);
 gint          g_date_time_get_second             (GDateTime      *datetime);
 void          g_date_time_get_utc_offset         (GDateTime      *datetime,
                                                   GTimeSpan      *timespan);
+void          g_date_time_get_value              (GDateTime      *datetime,
+                                                  GDateTimeValue *value);
 gint          g_date_time_get_year               (GDateTime      *datetime);
 guint         g_date_time_hash                   (gconstpointer   datetime);
 gboolean      g_date_time_is_leap_year           (GDateTime      *datetime);
@@ -97,14 +143,32 @@ gboolean      g_date_time_is_daylight_savings    (GDateTime      *datetime);
 GDateTime *   g_date_time_new_from_date          (gint            year,
                                                   gint            month,
                                                   gint            day);
+GDateTime *   g_date_time_new_from_gps           (gint64          gps);
+GDateTime *   g_date_time_new_from_tai           (gint64          tai);
 GDateTime *   g_date_time_new_from_time_t        (time_t          t);
 GDateTime *   g_date_time_new_from_timeval       (GTimeVal       *tv);
+GDateTime *   g_date_time_new_from_value         (const GDateTimeValue *value);
 GDateTime *   g_date_time_new_full               (gint            year,
                                                   gint            month,
                                                   gint            day,
                                                   gint            hour,
                                                   gint            minute,
                                                   gint            second);
+GDateTime *   g_date_time_new_full_with_resolve  (GTimeZone      *tz,
+                                                  GTimeResolve    resolve,
+                                                  gint            year,
+                                                  gint            month,
+                                                  gint            day,
+                                                  gint            hour,
+                                                  gint            minute,
+                                                  gint            second);
+GDateTime *   g_date_time_new_full_with_zone     (GTimeZone      *tz,
+                                                  gint            year,
+                                                  gint            month,
+                                                  gint            day,
+                                                  gint            hour,
+                                                  gint            minute,
+                                                  gint            second);
 GDateTime *   g_date_time_now                    (void);
 GDateTime *   g_date_time_parse                  (const gchar    *input);
 GDateTime *   g_date_time_parse_with_format      (const gchar    *format,
@@ -112,14 +176,93 @@ GDateTime *   g_date_time_parse_with_format      (const gchar    *format,
 gchar *       g_date_time_printf                 (GDateTime      *datetime,
                                                   const gchar    *format);
 GDateTime *   g_date_time_ref                    (GDateTime      *datetime);
+gint64        g_date_time_to_gps                 (GDateTime      *datetime);
 GDateTime *   g_date_time_to_local               (GDateTime      *datetime);
+gint64        g_date_time_to_tai                 (GDateTime      *datetime);
 time_t        g_date_time_to_time_t              (GDateTime      *datetime);
 void          g_date_time_to_timeval             (GDateTime      *datetime,
                                                   GTimeVal       *tv);
 GDateTime *   g_date_time_to_utc                 (GDateTime      *datetime);
+GDateTime *   g_date_time_to_zone                (GDateTime      *datetime,
+                                                  GTimeZone      *tz);
 GDateTime *   g_date_time_today                  (void);
 void          g_date_time_unref                  (GDateTime      *datetime);
 GDateTime *   g_date_time_utc_now                (void);
+void          g_date_time_value_add              (const GDateTimeValue *value,
+                                                  GTimeSpan             timespan,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_days         (const GDateTimeValue *value,
+                                                  gint                  days,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_full         (const GDateTimeValue *value,
+                                                  gint                  years,
+                                                  gint                  months,
+                                                  gint                  days,
+                                                  gint                  hours,
+                                                  gint                  minutes,
+                                                  gint                  seconds,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_hours        (const GDateTimeValue *value,
+                                                  gint                  hours,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_milliseconds (const GDateTimeValue *value,
+                                                  gint                  milliseconds,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_minutes      (const GDateTimeValue *value,
+                                                  gint                  minutes,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_months       (const GDateTimeValue *value,
+                                                  gint                  months,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_seconds      (const GDateTimeValue *value,
+                                                  gint                  seconds,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_weeks        (const GDateTimeValue *value,
+                                                  gint                  weeks,
+                                                  GDateTimeValue       *result);
+void          g_date_time_value_add_years        (const GDateTimeValue *value,
+                                                  gint                  years,
+                                                  GDateTimeValue       *result);
+gint          g_date_time_value_compare          (gconstpointer         v1,
+                                                  gconstpointer         v2);
+gboolean      g_date_time_value_equal            (gconstpointer         v1,
+                                                  gconstpointer         v2);
+gint          g_date_time_value_get_day_of_month (const GDateTimeValue *value);
+gint          g_date_time_value_get_day_of_week  (const GDateTimeValue *value);
+gint          g_date_time_value_get_day_of_year  (const GDateTimeValue *value);
+void          g_date_time_value_get_dmy          (const GDateTimeValue *value,
+                                                  gint                 *day,
+                                                  gint                 *month,
+                                                  gint                 *year);
+gint          g_date_time_value_get_hour         (const GDateTimeValue *value);
+gint          g_date_time_value_get_microsecond  (const GDateTimeValue *value);
+gint          g_date_time_value_get_millisecond  (const GDateTimeValue *value);
+gint          g_date_time_value_get_minute       (const GDateTimeValue *value);
+gint          g_date_time_value_get_month        (const GDateTimeValue *value);
+gint          g_date_time_value_get_second       (const GDateTimeValue *value);
+void          g_date_time_value_get_utc_offset   (const GDateTimeValue *value,
+                                                  GTimeSpan            *timespan);
+gint          g_date_time_value_get_year         (const GDateTimeValue *value);
+void          g_date_time_value_init_from_time_t (GDateTimeValue       *value,
+                                                  GTimeZone            *tz,
+                                                  time_t                t);
+gboolean      g_date_time_value_init_full        (GDateTimeValue       *value,
+                                                  GTimeZone            *tz,
+                                                  gint                  year,
+                                                  gint                  month,
+                                                  gint                  day,
+                                                  gint                  hour,
+                                                  gint                  minute,
+                                                  gint                  second);
+gboolean      g_date_time_value_is_daylight_savings (const GDateTimeValue *value);
+gboolean      g_date_time_value_is_leap_year     (const GDateTimeValue *value);
+gchar *       g_date_time_value_printf           (const GDateTimeValue *value,
+                                                  const gchar          *format);
+time_t        g_date_time_value_to_time_t        (const GDateTimeValue *value);
+void          g_date_time_value_to_zone          (const GDateTimeValue *value,
+                                                  GTimeZone            *tz,
+                                                  GDateTimeValue       *result);
+void          g_date_time_warm_up                (const gchar   **identifiers);
 
 G_END_DECLS
 
@@ -0,0 +1,3522 @@
+/* gtimezone.c
+ *
+ * Copyright (C) 2009-2010 Christian Hergert <chris@dronelabs.com>
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "gtimezone.h"
+
+/**
+ * SECTION:g-time-zone
+ * @title: GTimeZone
+ * @short_description: Time zones and their transitions
+ *
+ * #GTimeZone describes the offsets from UTC that are in effect within a
+ * timezone over time, along with their abbreviations and whether daylight
+ * savings is in effect.
+ *
+ * Zones are loaded from the zoneinfo database once per process and shared.
+ * Use g_time_zone_new() to retrieve a zone by name such as "Europe/Berlin",
+ * or g_time_zone_new_local() for the timezone of the process.
+ *
+ * #GTimeZone is reference counted and immutable, so it may be used from
+ * multiple threads at once.
+ *
+ * Since: 2.26
+ */
+
+typedef struct
+{
+  gint64       utc;             /* Instant the interval begins, seconds since Epoch */
+  gint32       gmtoff;          /* Offset seconds from UTC */
+  gboolean     is_dst;          /* If daylight savings is in effect */
+  const gchar *abbr;            /* Interned abbreviation such as "PST" */
+} GTimeZoneTransition;
+
+typedef enum
+{
+  G_TZ_RULE_JULIAN,             /* Jn, 1 to 365 never counting February 29 */
+  G_TZ_RULE_DAY,                /* n, 0 to 365 counting February 29 */
+  G_TZ_RULE_MONTH               /* Mm.w.d, day d of week w of month m */
+} GTzRuleType;
+
+typedef struct
+{
+  GTzRuleType type;
+  gint        month;            /* 1 to 12 */
+  gint        week;             /* 1 to 5, where 5 is the last week */
+  gint        day;              /* Day of year, or 0 (Sunday) to 6 */
+  gint32      time;             /* Seconds after local midnight */
+} GTzRuleDate;
+
+/*
+ * The daylight savings rule from a POSIX TZ string such as
+ * "CET-1CEST,M3.5.0,M10.5.0/3", which applies after the last transition.
+ */
+typedef struct
+{
+  gint32      std_offset;       /* Offset seconds from UTC in standard time */
+  gint32      dst_offset;       /* Offset seconds from UTC in daylight savings */
+  const gchar *std_abbr;        /* Interned abbreviations */
+  const gchar *dst_abbr;
+  gboolean    has_dst;          /* If daylight savings is ever in effect */
+  GTzRuleDate start;            /* Local standard time daylight savings begins */
+  GTzRuleDate end;              /* Local daylight time daylight savings ends */
+} GTzRule;
+
+struct _GTimeZone
+{
+  volatile gint        ref_count;
+  gboolean             permanent;     /* Registered, never freed or counted */
+  guint                id;            /* Index within the registry */
+  volatile gint        index;         /* Within zone_index, 0 if unindexed */
+
+  gchar               *identifier;    /* Name the zone was loaded by */
+  GTimeZoneTransition *transitions;   /* Sorted by utc, the first is G_MININT64 */
+  guint                n_transitions; /* Number of transitions */
+  guint                n_intervals;   /* Transitions plus the rule's intervals */
+  GTzRule             *rule;          /* Applies after the last transition */
+};
+
+/*
+ * Every zone loaded by g_time_zone_new() is registered here and is
+ * identified by its index within zones.  Zones are never freed.  Readers load
+ * the registry with g_atomic_pointer_get() and probe it without locking.
+ * Writers load the zone without any lock, then hold registry_lock only to
+ * store the zone and publish its slot, so no thread waits on another's I/O.
+ * When the registry fills up, a copy twice the size is published and the old
+ * one is retired but never freed, since readers may still be probing it.
+ *
+ * g_time_zone_refresh() only bumps generation.  A zone checked in an older
+ * generation is loaded again on its next lookup, and replaces the registered
+ * zone under the same id only if its rules changed, so refreshing leaks
+ * nothing unless the zoneinfo database really did change.
+ */
+typedef struct
+{
+  guint           size;         /* Number of slots, a power of two */
+  guint           n_zones;      /* Number of registered zones */
+  GTimeZone     **zones;        /* Registered zones by id */
+  volatile gint  *generations;  /* Generation each zone was last checked in */
+  volatile gint  *slots;        /* Hash of identifier to id + 1, 0 if empty */
+  gboolean        shared;       /* Read-only, see g_time_zone_share() */
+} GTimeZoneRegistry;
+
+static GStaticMutex       registry_lock = G_STATIC_MUTEX_INIT;
+static GTimeZoneRegistry *registry = NULL;
+static volatile gint      generation = 0;
+
+/*
+ * Zones given an index by g_time_zone_get_index(), so that a #GDateTime can
+ * refer to its zone with a small integer.  Unlike registry ids, indices are
+ * never reused, not even across g_time_zone_refresh(), and indexed zones are
+ * never freed.  Readers load the table with g_atomic_pointer_get() and index
+ * it without locking.  It grows like the registry, retiring the old copy
+ * without freeing it.  Index 0 is left unused.
+ */
+typedef struct
+{
+  guint          size;          /* Number of entries */
+  volatile gint  n_zones;       /* Number of entries in use, including 0 */
+  GTimeZone    **zones;         /* Indexed zones by index */
+} GTimeZoneIndex;
+
+static GStaticMutex       index_lock = G_STATIC_MUTEX_INIT;
+static GTimeZoneIndex    *zone_index = NULL;
+
+/*
+ * The local zone is loaded on first use and published with a compare and
+ * exchange.  Threads racing to load it each build a copy, and all but the
+ * first published are discarded.
+ */
+static GTimeZone         *local_zone = NULL;
+
+/*
+ * The local zone forgotten by the last g_time_zone_refresh(), reused instead
+ * of the reloaded copy if that turns out to be unchanged.
+ */
+static GTimeZone         *retired_local_zone = NULL;
+
+/*
+ * Abbreviations are interned into a single string table shared by every
+ * zone, since most zones use a handful of the same ones.  The memory held
+ * by zones and the table is accounted for g_time_zone_get_cache_stats().
+ */
+static GStaticMutex       cache_lock = G_STATIC_MUTEX_INIT;
+static GStringChunk      *abbrs_chunk = NULL;
+static GHashTable        *abbrs_table = NULL;
+static struct
+{
+  guint n_zones;
+  guint n_abbreviations;
+  gsize n_bytes;
+} cache_stats;
+
+/*
+ * Each thread remembers the last interval it found for instants and for
+ * local times, along with the range of times the interval covers.  Nearby
+ * timestamps, such as those of a log, are then resolved by two comparisons
+ * without searching the transitions.  Only registered zones are remembered
+ * since they are never freed.
+ */
+typedef struct
+{
+  GTimeZone *tz;
+  gint64     start;             /* First time within the interval */
+  gint64     end;               /* First time after the interval */
+  gint       interval;
+} GTimeZoneWindow;
+
+static GStaticPrivate windows_key = G_STATIC_PRIVATE_INIT;
+
+/*
+ * Zones pushed with g_time_zone_push_thread_default(), innermost last.
+ */
+static GStaticPrivate defaults_key = G_STATIC_PRIVATE_INIT;
+
+typedef struct
+{
+  gint32   gmtoff;              /* Offset seconds from UTC */
+  gboolean is_dst;              /* If this is a daylight savings type */
+  guint8   abbr_index;          /* Offset of the abbreviation in abbrs */
+} GTzType;
+
+typedef struct
+{
+  GMappedFile   *mapped;        /* The mmap()'d zoneinfo file */
+  guint          n_transitions; /* Number of transitions */
+  gint64        *transitions;   /* Transition instants, seconds since Epoch */
+  const guint8  *trans_types;   /* Type index for each transition (mapped) */
+  guint          n_types;       /* Number of local time types */
+  GTzType       *types;         /* Local time types */
+  const gchar   *abbrs;         /* NUL-separated abbreviations (mapped) */
+  guint          abbrs_len;     /* Length of abbrs */
+  gchar         *footer;        /* POSIX TZ string from v2+ files or NULL */
+  guint          n_leaps;       /* Number of leap second records */
+  const guint8  *leaps;         /* Leap second records (mapped) */
+  guint          leap_size;     /* Size of each leap second record */
+} GTzData;
+
+/*
+ * The number of seconds TAI is ahead of UTC is kept for each bucket of 32
+ * days from LEAP_EPOCH.  Leap seconds are months apart, so a bucket holds
+ * at most one of them and a lookup is an index and a comparison with the
+ * day within the bucket on which the offset changes.
+ */
+#define LEAP_EPOCH          (G_GINT64_CONSTANT (63072000)) /* 1972-01-01 */
+#define LEAP_BUCKET_DAYS    (32)
+
+typedef struct
+{
+  gint8  offset;                /* TAI - UTC at the start of the bucket */
+  gint8  step;                  /* Change of the offset within the bucket */
+  guint8 day;                   /* Day of the change, LEAP_BUCKET_DAYS if none */
+} GLeapBucket;
+
+typedef struct
+{
+  guint        n_buckets;
+  GLeapBucket *buckets;
+} GLeapTable;
+
+typedef struct
+{
+  gint64 utc;                   /* Midnight following the leap second */
+  gint   offset;                /* TAI - UTC from then on */
+} GLeapSecond;
+
+static GLeapTable   *leap_table = NULL;
+static GLeapTable   *retired_leap_table = NULL; /* Reused if still current */
+
+/*
+ * The built in timezone database is rather difficult to use from libc
+ * since there doesn't seem to be a way to get at the information for times
+ * other than 1970-2038.  Therefore the following methods do not provide
+ * accurate DST information for years not in that range.
+ *
+ * This method is based upon Mono's implementation which can be found at
+ * http://anonsvn.mono-project.com/source/trunk/mono/mono/metadata/icall.c
+ * and is dual-licensed under the GPL/LGPL.
+ *
+ * Authors through derivative works:
+ *   Dietmar Maurer (dietmar@ximian.com)
+ *   Paolo Molaro (lupus@ximian.com)
+ *   Patrik Torstensson (patrik.torstensson@labs2.com)
+ *
+ * Copyright 2001-2003 Ximian, Inc (http://www.ximian.com)
+ * Copyright 2004-2009 Novell, Inc (http://www.novell.com)
+ */
+static gint
+gmt_offset (struct tm *tm,
+            time_t     t)
+{
+#if defined (HAVE_TM_GMTOFF)
+  return tm->tm_gmtoff;
+#else
+  struct tm g;
+  time_t t2;
+  g = *gmtime (&t);
+  g.tm_isdst = tm->tm_isdst;
+  t2 = mktime (&g);
+  return (int)difftime (t, t2);
+#endif
+}
+
+/*
+ * Reading of the compiled zoneinfo database (TZif) as described in
+ * RFC 8536 and tzfile(5).  Versions 1, 2 and 3 of the format are
+ * supported.  When the file contains a version 2+ block, the 64-bit
+ * data is used so that instants before 1901 and after 2038 get the
+ * proper offsets.
+ */
+
+#define TZIF_HEADER_SIZE (44)
+#define SEC_PER_DAY      (G_GINT64_CONSTANT (86400))
+
+static guint32
+tzif_read_uint32 (const guint8 *p)
+{
+  return ((guint32)p [0] << 24) |
+         ((guint32)p [1] << 16) |
+         ((guint32)p [2] <<  8) |
+         ((guint32)p [3]);
+}
+
+static gint64
+tzif_read_int64 (const guint8 *p)
+{
+  return (gint64)(((guint64)tzif_read_uint32 (p) << 32) |
+                  tzif_read_uint32 (p + 4));
+}
+
+static void
+g_tz_data_free (GTzData *tzdata)
+{
+  if (tzdata)
+    {
+      g_free (tzdata->transitions);
+      g_free (tzdata->types);
+      g_free (tzdata->footer);
+      if (tzdata->mapped)
+        g_mapped_file_free (tzdata->mapped);
+      g_slice_free (GTzData, tzdata);
+    }
+}
+
+static gboolean
+g_tz_data_parse (GTzData      *tzdata,
+                 const guint8 *data,
+                 gsize         length)
+{
+  const guint8 *p,
+               *end;
+  guint32       isutcnt,
+                isstdcnt,
+                leapcnt,
+                timecnt,
+                typecnt,
+                charcnt,
+                time_size = 4,
+                i;
+  gsize         block;
+
+  end = data + length;
+  p = data;
+
+  if (length < TZIF_HEADER_SIZE || memcmp (p, "TZif", 4) != 0)
+    return FALSE;
+
+  /* Skip the version 1 data block if a 64-bit block follows it. */
+  if (p [4] >= '2')
+    {
+      isutcnt  = tzif_read_uint32 (p + 20);
+      isstdcnt = tzif_read_uint32 (p + 24);
+      leapcnt  = tzif_read_uint32 (p + 28);
+      timecnt  = tzif_read_uint32 (p + 32);
+      typecnt  = tzif_read_uint32 (p + 36);
+      charcnt  = tzif_read_uint32 (p + 40);
+
+      block = (gsize)timecnt * 5 + (gsize)typecnt * 6 + charcnt +
+              (gsize)leapcnt * 8 + isstdcnt + isutcnt;
+
+      if (block > (gsize)(end - p) - TZIF_HEADER_SIZE)
+        return FALSE;
+
+      p += TZIF_HEADER_SIZE + block;
+      time_size = 8;
+
+      if ((gsize)(end - p) < TZIF_HEADER_SIZE || memcmp (p, "TZif", 4) != 0)
+        return FALSE;
+    }
+
+  isutcnt  = tzif_read_uint32 (p + 20);
+  isstdcnt = tzif_read_uint32 (p + 24);
+  leapcnt  = tzif_read_uint32 (p + 28);
+  timecnt  = tzif_read_uint32 (p + 32);
+  typecnt  = tzif_read_uint32 (p + 36);
+  charcnt  = tzif_read_uint32 (p + 40);
+
+  if (typecnt == 0 || typecnt > 256 || charcnt == 0)
+    return FALSE;
+
+  block = (gsize)timecnt * (time_size + 1) + (gsize)typecnt * 6 + charcnt +
+          (gsize)leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+
+  if (block > (gsize)(end - p) - TZIF_HEADER_SIZE)
+    return FALSE;
+
+  p += TZIF_HEADER_SIZE;
+
+  tzdata->n_transitions = timecnt;
+  tzdata->transitions = g_new (gint64, MAX (timecnt, 1));
+  for (i = 0; i < timecnt; i++, p += time_size)
+    {
+      if (time_size == 8)
+        tzdata->transitions [i] = tzif_read_int64 (p);
+      else
+        tzdata->transitions [i] = (gint32)tzif_read_uint32 (p);
+    }
+
+  tzdata->trans_types = p;
+  for (i = 0; i < timecnt; i++, p++)
+    if (*p >= typecnt)
+      return FALSE;
+
+  tzdata->n_types = typecnt;
+  tzdata->types = g_new (GTzType, typecnt);
+  for (i = 0; i < typecnt; i++, p += 6)
+    {
+      tzdata->types [i].gmtoff = (gint32)tzif_read_uint32 (p);
+      tzdata->types [i].is_dst = p [4] != 0;
+      tzdata->types [i].abbr_index = p [5];
+      if (p [5] >= charcnt)
+        return FALSE;
+    }
+
+  tzdata->abbrs = (const gchar *)p;
+  tzdata->abbrs_len = charcnt;
+  if (tzdata->abbrs [charcnt - 1] != '\0')
+    return FALSE;
+
+  p += charcnt;
+
+  tzdata->n_leaps = leapcnt;
+  tzdata->leaps = p;
+  tzdata->leap_size = time_size + 4;
+
+  p += (gsize)leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+
+  /* The footer is "\n<POSIX TZ string>\n" in version 2+ files. */
+  if (time_size == 8 && p < end && *p == '\n')
+    {
+      const guint8 *nl;
+
+      nl = memchr (p + 1, '\n', end - (p + 1));
+      if (nl)
+        tzdata->footer = g_strndup ((const gchar *)p + 1, nl - (p + 1));
+    }
+
+  return TRUE;
+}
+
+static GTzData*
+g_tz_data_new_from_file (const gchar *filename)
+{
+  GTzData     *tzdata;
+  GMappedFile *mapped;
+
+  if (!(mapped = g_mapped_file_new (filename, FALSE, NULL)))
+    return NULL;
+
+  tzdata = g_slice_new0 (GTzData);
+  tzdata->mapped = mapped;
+
+  if (!g_tz_data_parse (tzdata,
+                        (const guint8 *)g_mapped_file_get_contents (mapped),
+                        g_mapped_file_get_length (mapped)))
+    {
+      g_tz_data_free (tzdata);
+      return NULL;
+    }
+
+  return tzdata;
+}
+
+#ifdef HAVE_BUILTIN_TZDATA
+/*
+ * A zone within the snapshot of the zoneinfo database written by
+ * gtzdata-gen, sorted by identifier.
+ */
+typedef struct
+{
+  const gchar  *identifier;
+  const guint8 *data;
+  gsize         length;
+} GTzBuiltin;
+
+#include "gtzdata.h"
+
+static gint
+g_tz_builtin_compare (gconstpointer identifier,
+                      gconstpointer builtin)
+{
+  return strcmp (identifier, ((const GTzBuiltin *)builtin)->identifier);
+}
+
+/*
+ * Reads the zone named @identifier from the snapshot of the zoneinfo
+ * database linked into the library, which needs no I/O.
+ */
+static GTzData*
+g_tz_data_new_from_builtin (const gchar *identifier)
+{
+  const GTzBuiltin *builtin;
+  GTzData          *tzdata;
+
+  if (!(builtin = bsearch (identifier, builtin_zones,
+                           G_N_ELEMENTS (builtin_zones), sizeof (GTzBuiltin),
+                           g_tz_builtin_compare)))
+    return NULL;
+
+  tzdata = g_slice_new0 (GTzData);
+
+  if (!g_tz_data_parse (tzdata, builtin->data, builtin->length))
+    {
+      g_tz_data_free (tzdata);
+      return NULL;
+    }
+
+  return tzdata;
+}
+#else
+static GTzData*
+g_tz_data_new_from_builtin (const gchar *identifier)
+{
+  return NULL;
+}
+#endif
+
+static gchar*
+g_tz_data_get_filename (const gchar *identifier)
+{
+  const gchar *tzdir;
+
+  if (g_path_is_absolute (identifier))
+    return g_strdup (identifier);
+
+  if (!(tzdir = g_getenv ("TZDIR")))
+    tzdir = "/usr/share/zoneinfo";
+
+  return g_build_filename (tzdir, identifier, NULL);
+}
+
+/*
+ * Retrieves the name of the local timezone as given by $TZ, or %NULL if
+ * /etc/localtime should be used.
+ */
+static const gchar*
+g_time_zone_get_local_identifier (void)
+{
+  const gchar *tz;
+
+  if (!(tz = g_getenv ("TZ")))
+    return NULL;
+
+  if (*tz == ':')
+    tz++;
+
+  if (*tz == '\0')
+    tz = "UTC";
+
+  return tz;
+}
+
+/*
+ * Retrieves the copy of @abbr shared by every zone, adding it to the
+ * string table if no zone used it before.  Interned strings never move
+ * and are never freed.
+ */
+static const gchar*
+g_time_zone_intern_abbr (const gchar *abbr)
+{
+  const gchar *interned;
+
+  g_static_mutex_lock (&cache_lock);
+
+  if (!abbrs_chunk)
+    {
+      abbrs_chunk = g_string_chunk_new (512);
+      abbrs_table = g_hash_table_new (g_str_hash, g_str_equal);
+    }
+
+  if (!(interned = g_hash_table_lookup (abbrs_table, abbr)))
+    {
+      interned = g_string_chunk_insert (abbrs_chunk, abbr);
+      g_hash_table_insert (abbrs_table, (gpointer)interned, (gpointer)interned);
+      cache_stats.n_abbreviations++;
+      cache_stats.n_bytes += strlen (abbr) + 1;
+    }
+
+  g_static_mutex_unlock (&cache_lock);
+
+  return interned;
+}
+
+/*
+ * Retrieves the number of bytes allocated for @tz, not counting its
+ * interned abbreviations.
+ */
+static gsize
+g_time_zone_get_size (GTimeZone *tz)
+{
+  return sizeof (GTimeZone)
+       + strlen (tz->identifier) + 1
+       + tz->n_intervals * sizeof (GTimeZoneTransition)
+       + (tz->rule ? sizeof (GTzRule) : 0);
+}
+
+/*
+ * Evaluation of POSIX TZ rules as found in $TZ and in the footer of
+ * version 2+ zoneinfo files.  Rather than expanding the rule into
+ * transitions for every year, the transitions of the year in question are
+ * computed on demand, which takes constant time for any year.
+ */
+
+static gint64
+g_tz_floor_div (gint64 a,
+                gint64 b)
+{
+  return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+}
+
+/*
+ * Days since the Epoch of a date in the proleptic gregorian calendar.
+ */
+static gint64
+g_tz_days_from_civil (gint64 year,
+                      gint   month,
+                      gint   day)
+{
+  gint64 era,
+         yoe,
+         doy;
+
+  year -= month <= 2;
+  era = g_tz_floor_div (year, 400);
+  yoe = year - era * 400;
+  doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+
+  return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+/*
+ * Gregorian year containing @days since the Epoch.
+ */
+static gint64
+g_tz_year_from_days (gint64 days)
+{
+  gint64 era,
+         doe,
+         yoe,
+         doy,
+         mp;
+
+  days += 719468;
+  era = g_tz_floor_div (days, 146097);
+  doe = days - era * 146097;
+  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  mp = (5 * doy + 2) / 153;
+
+  return yoe + era * 400 + (mp >= 10);
+}
+
+/*
+ * Wall clock time of @date within @year, in seconds since the Epoch.
+ */
+static gint64
+g_tz_rule_date_get_time (const GTzRuleDate *date,
+                         gint64             year)
+{
+  gint64 days,
+         first,
+         last;
+  gint   wday;
+
+  switch (date->type)
+    {
+    case G_TZ_RULE_JULIAN:
+      days = g_tz_days_from_civil (year, 1, 1) + date->day - 1;
+      if (date->day >= 60 &&
+          year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+        days++;
+      break;
+
+    case G_TZ_RULE_DAY:
+      days = g_tz_days_from_civil (year, 1, 1) + date->day;
+      break;
+
+    case G_TZ_RULE_MONTH:
+    default:
+      first = g_tz_days_from_civil (year, date->month, 1);
+      if (date->month == 12)
+        last = g_tz_days_from_civil (year + 1, 1, 1);
+      else
+        last = g_tz_days_from_civil (year, date->month + 1, 1);
+
+      /* The Epoch was a Thursday */
+      wday = (gint)(first - g_tz_floor_div (first + 4, 7) * 7 + 4);
+      days = first + (date->day - wday + 7) % 7 + (date->week - 1) * 7;
+      while (days >= last)
+        days -= 7;
+      break;
+    }
+
+  return days * SEC_PER_DAY + date->time;
+}
+
+/*
+ * Computes when daylight savings starts and ends within @year, as instants
+ * or as local times depending on @type.  Local times that are skipped or
+ * repeated resolve to standard time, like g_time_zone_find_local() does for
+ * the transition table.
+ */
+static void
+g_tz_rule_get_range (const GTzRule *rule,
+                     GTimeType      type,
+                     gint64         year,
+                     gint64        *start,
+                     gint64        *end)
+{
+  *start = g_tz_rule_date_get_time (&rule->start, year) - rule->std_offset;
+  *end = g_tz_rule_date_get_time (&rule->end, year) - rule->dst_offset;
+
+  if (type == G_TIME_TYPE_LOCAL)
+    {
+      *start += rule->dst_offset;
+      *end += rule->std_offset;
+    }
+}
+
+/*
+ * Determines if daylight savings is in effect at @time_ according to
+ * @rule.  The range of times around @time_ for which the answer stays the
+ * same is stored in @window_start and @window_end.
+ */
+static gboolean
+g_tz_rule_is_dst (const GTzRule *rule,
+                  GTimeType      type,
+                  gint64         time_,
+                  gint64        *window_start,
+                  gint64        *window_end)
+{
+  gint64 year,
+         start,
+         end,
+         edges [2];
+  gint   i,
+         j;
+
+  if (type == G_TIME_TYPE_LOCAL)
+    year = g_tz_year_from_days (g_tz_floor_div (time_, SEC_PER_DAY));
+  else
+    year = g_tz_year_from_days (g_tz_floor_div (time_ + rule->std_offset,
+                                                SEC_PER_DAY));
+
+  /* Keep the arithmetic for absurd instants from overflowing */
+  year = CLAMP (year, -1000000, 1000000);
+
+  *window_start = G_MININT64;
+  *window_end = G_MAXINT64;
+
+  /* The nearest transitions may fall in the neighbouring years */
+  for (i = -1; i <= 1; i++)
+    {
+      g_tz_rule_get_range (rule, type, year + i, &edges [0], &edges [1]);
+
+      for (j = 0; j < 2; j++)
+        {
+          if (edges [j] <= time_ && edges [j] > *window_start)
+            *window_start = edges [j];
+          else if (edges [j] > time_ && edges [j] < *window_end)
+            *window_end = edges [j];
+        }
+    }
+
+  g_tz_rule_get_range (rule, type, year, &start, &end);
+
+  /* Daylight savings spans the new year in the southern hemisphere */
+  if (start < end)
+    return start <= time_ && time_ < end;
+  else
+    return time_ < end || start <= time_;
+}
+
+static gboolean
+g_tz_rule_parse_number (const gchar **str,
+                        gint          max,
+                        gint         *value)
+{
+  const gchar *p = *str;
+
+  if (!g_ascii_isdigit (*p))
+    return FALSE;
+
+  for (*value = 0; g_ascii_isdigit (*p); p++)
+    if ((*value = (*value * 10) + (*p - '0')) > max)
+      return FALSE;
+
+  *str = p;
+
+  return TRUE;
+}
+
+/*
+ * Parses "[+-]hh[:mm[:ss]]" into seconds.  Hours may go up to 167 as
+ * allowed for transition times by RFC 8536.
+ */
+static gboolean
+g_tz_rule_parse_time (const gchar **str,
+                      gint32       *seconds)
+{
+  const gchar *p = *str;
+  gint         sign = 1,
+               hours,
+               minutes = 0,
+               secs = 0;
+
+  if (*p == '+' || *p == '-')
+    sign = (*p++ == '-') ? -1 : 1;
+
+  if (!g_tz_rule_parse_number (&p, 167, &hours))
+    return FALSE;
+
+  if (*p == ':')
+    {
+      p++;
+      if (!g_tz_rule_parse_number (&p, 59, &minutes))
+        return FALSE;
+
+      if (*p == ':')
+        {
+          p++;
+          if (!g_tz_rule_parse_number (&p, 59, &secs))
+            return FALSE;
+        }
+    }
+
+  *seconds = sign * ((hours * 3600) + (minutes * 60) + secs);
+  *str = p;
+
+  return TRUE;
+}
+
+/*
+ * Parses an abbreviation, either alphabetic such as "CEST" or quoted such
+ * as "<+0330>", and interns it.
+ */
+static gboolean
+g_tz_rule_parse_name (const gchar  **str,
+                      const gchar  **abbr)
+{
+  const gchar *p = *str,
+              *begin;
+  gchar       *name;
+
+  if (*p == '<')
+    {
+      for (begin = ++p; g_ascii_isalpha (*p) || g_ascii_isdigit (*p) ||
+                        *p == '+' || *p == '-'; p++);
+
+      if (*p != '>')
+        return FALSE;
+
+      name = g_strndup (begin, p++ - begin);
+    }
+  else
+    {
+      for (begin = p; g_ascii_isalpha (*p); p++);
+      name = g_strndup (begin, p - begin);
+    }
+
+  if (strlen (name) < 3)
+    {
+      g_free (name);
+      return FALSE;
+    }
+
+  *abbr = g_time_zone_intern_abbr (name);
+  *str = p;
+  g_free (name);
+
+  return TRUE;
+}
+
+static gboolean
+g_tz_rule_parse_date (const gchar **str,
+                      GTzRuleDate  *date)
+{
+  const gchar *p = *str;
+
+  memset (date, 0, sizeof (GTzRuleDate));
+
+  if (*p == 'J')
+    {
+      p++;
+      date->type = G_TZ_RULE_JULIAN;
+      if (!g_tz_rule_parse_number (&p, 365, &date->day) || date->day < 1)
+        return FALSE;
+    }
+  else if (*p == 'M')
+    {
+      p++;
+      date->type = G_TZ_RULE_MONTH;
+      if (!g_tz_rule_parse_number (&p, 12, &date->month) || date->month < 1 ||
+          *p++ != '.' ||
+          !g_tz_rule_parse_number (&p, 5, &date->week) || date->week < 1 ||
+          *p++ != '.' ||
+          !g_tz_rule_parse_number (&p, 6, &date->day))
+        return FALSE;
+    }
+  else
+    {
+      date->type = G_TZ_RULE_DAY;
+      if (!g_tz_rule_parse_number (&p, 365, &date->day))
+        return FALSE;
+    }
+
+  /* Transitions happen at 02:00 unless told otherwise */
+  date->time = 7200;
+
+  if (*p == '/')
+    {
+      p++;
+      if (!g_tz_rule_parse_time (&p, &date->time))
+        return FALSE;
+    }
+
+  *str = p;
+
+  return TRUE;
+}
+
+/*
+ * Parses a POSIX TZ string such as "EST5EDT,M3.2.0,M11.1.0" into @rule.
+ * Offsets in the string are west of UTC, while those of @rule are east of
+ * UTC like everywhere else.
+ */
+static gboolean
+g_tz_rule_parse (const gchar *str,
+                 GTzRule     *rule)
+{
+  const gchar *p = str;
+  gint32       offset;
+
+  memset (rule, 0, sizeof (GTzRule));
+
+  if (!g_tz_rule_parse_name (&p, &rule->std_abbr) ||
+      !g_tz_rule_parse_time (&p, &offset))
+    return FALSE;
+
+  rule->std_offset = -offset;
+
+  if (*p == '\0')
+    return TRUE;
+
+  if (!g_tz_rule_parse_name (&p, &rule->dst_abbr))
+    return FALSE;
+
+  rule->dst_offset = rule->std_offset + 3600;
+
+  if (*p != ',' && *p != '\0')
+    {
+      if (!g_tz_rule_parse_time (&p, &offset))
+        return FALSE;
+      rule->dst_offset = -offset;
+    }
+
+  if (*p == '\0')
+    {
+      /* Without dates, follow the United States as glibc does */
+      const gchar *us = "M3.2.0,M11.1.0";
+
+      g_tz_rule_parse_date (&us, &rule->start);
+      us++;
+      g_tz_rule_parse_date (&us, &rule->end);
+    }
+  else if (*p++ != ',' ||
+           !g_tz_rule_parse_date (&p, &rule->start) ||
+           *p++ != ',' ||
+           !g_tz_rule_parse_date (&p, &rule->end) ||
+           *p != '\0')
+    return FALSE;
+
+  rule->has_dst = TRUE;
+
+  return TRUE;
+}
+
+/*
+ * Takes ownership of @transitions.  If @rule is given, its
+ * standard and daylight savings intervals are appended after the last
+ * transition so that they can be looked up like any other interval.
+ */
+static GTimeZone*
+g_time_zone_new_from_arrays (const gchar   *identifier,
+                             GArray        *transitions,
+                             const GTzRule *rule)
+{
+  GTimeZoneTransition  trans;
+  GTimeZone           *tz;
+
+  tz = g_slice_new0 (GTimeZone);
+  tz->ref_count = 1;
+  tz->identifier = g_strdup (identifier);
+  tz->n_transitions = transitions->len;
+
+  if (rule && rule->has_dst)
+    {
+      trans.utc = G_MAXINT64;
+      trans.gmtoff = rule->std_offset;
+      trans.is_dst = FALSE;
+      trans.abbr = rule->std_abbr;
+      g_array_append_val (transitions, trans);
+
+      trans.gmtoff = rule->dst_offset;
+      trans.is_dst = TRUE;
+      trans.abbr = rule->dst_abbr;
+      g_array_append_val (transitions, trans);
+
+      tz->rule = g_slice_new (GTzRule);
+      *tz->rule = *rule;
+    }
+
+  tz->n_intervals = transitions->len;
+  tz->transitions = (GTimeZoneTransition *)g_array_free (transitions, FALSE);
+
+  g_static_mutex_lock (&cache_lock);
+  cache_stats.n_zones++;
+  cache_stats.n_bytes += g_time_zone_get_size (tz);
+  g_static_mutex_unlock (&cache_lock);
+
+  return tz;
+}
+
+/*
+ * Builds a #GTimeZone from the transition table of a zoneinfo file.  The
+ * interval before the first transition uses time type 0 as per RFC 8536.
+ */
+static GTimeZone*
+g_time_zone_new_from_tz_data (const gchar *identifier,
+                              GTzData     *tzdata)
+{
+  GTimeZoneTransition  trans;
+  GTzType             *type;
+  GTzRule              rule;
+  GArray              *transitions;
+  gboolean             has_rule;
+  guint                i;
+
+  transitions = g_array_sized_new (FALSE, FALSE, sizeof (GTimeZoneTransition),
+                                   tzdata->n_transitions + 1);
+
+  for (i = 0; i <= tzdata->n_transitions; i++)
+    {
+      if (i == 0)
+        {
+          type = &tzdata->types [0];
+          trans.utc = G_MININT64;
+        }
+      else
+        {
+          type = &tzdata->types [tzdata->trans_types [i - 1]];
+          trans.utc = tzdata->transitions [i - 1];
+        }
+
+      trans.gmtoff = type->gmtoff;
+      trans.is_dst = type->is_dst;
+      trans.abbr = g_time_zone_intern_abbr (tzdata->abbrs + type->abbr_index);
+      g_array_append_val (transitions, trans);
+    }
+
+  /* The footer describes the years after the last transition */
+  has_rule = tzdata->footer && g_tz_rule_parse (tzdata->footer, &rule);
+
+  return g_time_zone_new_from_arrays (identifier, transitions,
+                                      has_rule ? &rule : NULL);
+}
+
+/*
+ * Zones built by probing libc are expensive to compute, so they are saved
+ * in the user's cache directory for later processes.  A cache file holds a
+ * GTzCacheHeader, the transitions and then the NUL-terminated identifier,
+ * source and abbreviations.  The source describes the file libc read the
+ * zone from, see g_tz_cache_get_source().  Files written for another
+ * identifier, source or format, or that fail their checksum, are ignored.
+ */
+#define CACHE_MAGIC   "GTZcache"
+#define CACHE_VERSION (2)
+
+typedef struct
+{
+  gchar   magic [8];            /* CACHE_MAGIC */
+  guint32 version;              /* CACHE_VERSION, also detects byte order */
+  guint32 checksum;             /* FNV-1a hash of everything that follows */
+  guint32 n_transitions;        /* Number of transitions */
+  guint32 strings_len;          /* Length of the strings after them */
+} GTzCacheHeader;
+
+typedef struct
+{
+  gint64  utc;
+  gint32  gmtoff;
+  guint16 is_dst;
+  guint16 abbr;                 /* Offset of the abbreviation in the strings */
+} GTzCacheTransition;
+
+static guint32
+g_tz_cache_checksum (const guint8 *data,
+                     gsize         length)
+{
+  guint32 hash = 2166136261U;
+  gsize   i;
+
+  for (i = 0; i < length; i++)
+    hash = (hash ^ data [i]) * 16777619U;
+
+  return hash;
+}
+
+/*
+ * Describes the file libc reads the zone named @identifier from by its
+ * resolved path, device, inode, size and modification time.  The host zone
+ * is read from /etc/localtime, whose target is resolved, so the cache is
+ * ignored once the file is updated or the link is pointed at another zone.
+ */
+static gchar*
+g_tz_cache_get_source (const gchar *identifier)
+{
+  struct stat  st;
+  gchar       *filename,
+              *source,
+               resolved [PATH_MAX];
+
+  if (strcmp (identifier, "localtime") == 0)
+    filename = g_strdup ("/etc/localtime");
+  else
+    filename = g_tz_data_get_filename (identifier);
+
+  if (realpath (filename, resolved) && stat (resolved, &st) == 0)
+    source = g_strdup_printf ("%s %lu %lu %" G_GINT64_FORMAT
+                              " %" G_GINT64_FORMAT, resolved,
+                              (gulong)st.st_dev, (gulong)st.st_ino,
+                              (gint64)st.st_size, (gint64)st.st_mtime);
+  else
+    source = g_strdup ("missing");
+
+  g_free (filename);
+
+  return source;
+}
+
+static gchar*
+g_tz_cache_get_filename (const gchar *identifier)
+{
+  GString     *name;
+  const gchar *p;
+  gchar       *filename;
+
+  /* Identifiers may hold slashes, so escape everything but alphanumerics */
+  name = g_string_new (NULL);
+  for (p = identifier; *p; p++)
+    {
+      if (g_ascii_isalnum (*p))
+        g_string_append_c (name, *p);
+      else
+        g_string_append_printf (name, "%%%02x", (guchar)*p);
+    }
+
+  filename = g_build_filename (g_get_user_cache_dir (), "gtimezone",
+                               name->str, NULL);
+  g_string_free (name, TRUE);
+
+  return filename;
+}
+
+/*
+ * Loads the zone named @identifier from the cache, or returns %NULL if it
+ * is missing or out of date.
+ */
+static GTimeZone*
+g_tz_cache_load (const gchar *identifier,
+                 const gchar *source)
+{
+  const GTzCacheHeader     *header;
+  const GTzCacheTransition *cached;
+  const gchar              *strings,
+                           *cached_source;
+  GTimeZoneTransition       trans;
+  GTimeZone                *tz = NULL;
+  GMappedFile              *mapped;
+  GArray                   *transitions;
+  gchar                    *filename;
+  const guint8             *data;
+  gsize                     length;
+  guint                     i;
+
+  filename = g_tz_cache_get_filename (identifier);
+  mapped = g_mapped_file_new (filename, FALSE, NULL);
+  g_free (filename);
+
+  if (!mapped)
+    return NULL;
+
+  data = (const guint8 *)g_mapped_file_get_contents (mapped);
+  length = g_mapped_file_get_length (mapped);
+  header = (const GTzCacheHeader *)data;
+
+  if (length < sizeof (GTzCacheHeader) ||
+      memcmp (header->magic, CACHE_MAGIC, 8) != 0 ||
+      header->version != CACHE_VERSION ||
+      header->n_transitions == 0 ||
+      header->n_transitions > (length - sizeof (GTzCacheHeader)) /
+                              sizeof (GTzCacheTransition) ||
+      length != sizeof (GTzCacheHeader) +
+                header->n_transitions * sizeof (GTzCacheTransition) +
+                header->strings_len ||
+      header->checksum != g_tz_cache_checksum (data + sizeof (GTzCacheHeader),
+                                               length - sizeof (GTzCacheHeader)))
+    goto out;
+
+  cached = (const GTzCacheTransition *)(data + sizeof (GTzCacheHeader));
+  strings = (const gchar *)(cached + header->n_transitions);
+
+  if (header->strings_len == 0 || strings [header->strings_len - 1] != '\0' ||
+      strcmp (strings, identifier) != 0)
+    goto out;
+
+  cached_source = strings + strlen (strings) + 1;
+  if (cached_source >= strings + header->strings_len ||
+      strcmp (cached_source, source) != 0)
+    goto out;
+
+  for (i = 0; i < header->n_transitions; i++)
+    if (cached [i].abbr >= header->strings_len)
+      goto out;
+
+  transitions = g_array_sized_new (FALSE, FALSE, sizeof (GTimeZoneTransition),
+                                   header->n_transitions);
+  for (i = 0; i < header->n_transitions; i++)
+    {
+      trans.utc = cached [i].utc;
+      trans.gmtoff = cached [i].gmtoff;
+      trans.is_dst = cached [i].is_dst != 0;
+      trans.abbr = g_time_zone_intern_abbr (strings + cached [i].abbr);
+      g_array_append_val (transitions, trans);
+    }
+
+  tz = g_time_zone_new_from_arrays (identifier, transitions, NULL);
+
+out:
+  g_mapped_file_free (mapped);
+
+  return tz;
+}
+
+/*
+ * Saves @tz to the cache.  Failures are ignored since the cache is only an
+ * optimization.
+ */
+static void
+g_tz_cache_save (GTimeZone   *tz,
+                 const gchar *source)
+{
+  GTzCacheTransition  cached;
+  GTzCacheHeader      header;
+  GString            *data,
+                     *strings;
+  gchar              *filename,
+                     *dirname;
+  const gchar        *p;
+  guint               i;
+
+  strings = g_string_new (NULL);
+  g_string_append_len (strings, tz->identifier, strlen (tz->identifier) + 1);
+  g_string_append_len (strings, source, strlen (source) + 1);
+
+  /* The header is filled in once the checksum is known */
+  memset (&header, 0, sizeof (GTzCacheHeader));
+  data = g_string_new (NULL);
+  g_string_append_len (data, (const gchar *)&header, sizeof (GTzCacheHeader));
+
+  for (i = 0; i < tz->n_transitions; i++)
+    {
+      /* Abbreviations are few, so the search for duplicates is short */
+      for (p = strings->str; p < strings->str + strings->len; p += strlen (p) + 1)
+        if (strcmp (p, tz->transitions [i].abbr) == 0)
+          break;
+
+      if (p == strings->str + strings->len)
+        g_string_append_len (strings, tz->transitions [i].abbr,
+                             strlen (tz->transitions [i].abbr) + 1);
+
+      memset (&cached, 0, sizeof (GTzCacheTransition));
+      cached.utc = tz->transitions [i].utc;
+      cached.gmtoff = tz->transitions [i].gmtoff;
+      cached.is_dst = tz->transitions [i].is_dst;
+      cached.abbr = p - strings->str;
+      g_string_append_len (data, (const gchar *)&cached,
+                           sizeof (GTzCacheTransition));
+    }
+
+  g_string_append_len (data, strings->str, strings->len);
+
+  memcpy (header.magic, CACHE_MAGIC, 8);
+  header.version = CACHE_VERSION;
+  header.n_transitions = tz->n_transitions;
+  header.strings_len = strings->len;
+  header.checksum = g_tz_cache_checksum ((const guint8 *)data->str +
+                                         sizeof (GTzCacheHeader),
+                                         data->len - sizeof (GTzCacheHeader));
+  memcpy (data->str, &header, sizeof (GTzCacheHeader));
+
+  filename = g_tz_cache_get_filename (tz->identifier);
+  dirname = g_path_get_dirname (filename);
+
+  /* g_file_set_contents() renames a temporary file into place */
+  if (g_mkdir_with_parents (dirname, 0700) == 0 && strings->len <= G_MAXUINT16)
+    g_file_set_contents (filename, data->str, data->len, NULL);
+
+  g_free (dirname);
+  g_free (filename);
+  g_string_free (strings, TRUE);
+  g_string_free (data, TRUE);
+}
+
+/*
+ * The libc fallback samples the offset once a week and bisects each step in
+ * which it changed.  For four weeks after each change it samples daily
+ * instead, since zones such as Africa/Casablanca suspend daylight savings
+ * for short periods close to their regular changes.  Changes that undo
+ * each other between two samples are missed.
+ */
+#define LIBC_PROBE_STEP   (7 * 86400)
+#define LIBC_PROBE_NEAR   (28 * 86400)
+#define LIBC_PROBE_DAY    (86400)
+#define LIBC_PROBE_END    (2145916800)  /* 2038-01-01 */
+
+/*
+ * Whether libc describes @t with the same local time type as @trans.
+ */
+static gboolean
+g_tz_libc_matches (time_t                     t,
+                   const GTimeZoneTransition *trans)
+{
+  struct tm tt;
+
+  localtime_r (&t, &tt);
+
+  return gmt_offset (&tt, t) == trans->gmtoff &&
+         (tt.tm_isdst > 0) == trans->is_dst;
+}
+
+/*
+ * Fallback for systems without zoneinfo files.  Probes libc with
+ * localtime_r() from 1970 through 2037, which is the only range it
+ * reliably knows about, finding each change of offset to the second in
+ * about 20 calls.  A zone changing twice a year takes about 10000 calls,
+ * so the result is cached on disk for later processes.
+ */
+static GTimeZone*
+g_time_zone_new_from_libc (const gchar *identifier)
+{
+  GTimeZoneTransition  trans;
+  GArray              *transitions;
+  time_t               t,
+                       end,
+                       near,
+                       lo,
+                       hi,
+                       mid;
+  struct tm            tt;
+  gchar                tzone [64],
+                      *source;
+  GTimeZone           *tz;
+
+  source = g_tz_cache_get_source (identifier);
+
+  if ((tz = g_tz_cache_load (identifier, source)))
+    {
+      g_free (source);
+      return tz;
+    }
+
+  transitions = g_array_new (FALSE, FALSE, sizeof (GTimeZoneTransition));
+
+  t = 0;
+  localtime_r (&t, &tt);
+  strftime (tzone, sizeof (tzone), "%Z", &tt);
+
+  trans.utc = G_MININT64;
+  trans.gmtoff = gmt_offset (&tt, t);
+  trans.is_dst = tt.tm_isdst > 0;
+  trans.abbr = g_time_zone_intern_abbr (tzone);
+  g_array_append_val (transitions, trans);
+
+  for (near = 0; t < (time_t)LIBC_PROBE_END; t = end)
+    {
+      end = t + (t < near ? LIBC_PROBE_DAY : LIBC_PROBE_STEP);
+      end = MIN (end, (time_t)LIBC_PROBE_END);
+
+      if (g_tz_libc_matches (end, &trans))
+        continue;
+
+      /* The last instant of the old type is lo, the first of the new hi */
+      for (lo = t, hi = end; hi - lo > 1; )
+        {
+          mid = lo + (hi - lo) / 2;
+          if (g_tz_libc_matches (mid, &trans))
+            lo = mid;
+          else
+            hi = mid;
+        }
+
+      localtime_r (&hi, &tt);
+      strftime (tzone, sizeof (tzone), "%Z", &tt);
+
+      trans.utc = hi;
+      trans.gmtoff = gmt_offset (&tt, hi);
+      trans.is_dst = tt.tm_isdst > 0;
+      trans.abbr = g_time_zone_intern_abbr (tzone);
+      g_array_append_val (transitions, trans);
+
+      /* Sampling starts again from the change, daily for a while */
+      end = hi;
+      near = hi + LIBC_PROBE_NEAR;
+    }
+
+  tz = g_time_zone_new_from_arrays (identifier, transitions, NULL);
+  g_tz_cache_save (tz, source);
+  g_free (source);
+
+  return tz;
+}
+
+/*
+ * Creates a zone without transitions that is always @gmtoff seconds from
+ * UTC, using @abbr as its abbreviation.
+ */
+static GTimeZone*
+g_time_zone_new_fixed (const gchar *identifier,
+                       gint32       gmtoff,
+                       const gchar *abbr)
+{
+  GTimeZoneTransition  trans;
+  GArray              *transitions;
+
+  transitions = g_array_sized_new (FALSE, FALSE,
+                                   sizeof (GTimeZoneTransition), 1);
+
+  trans.utc = G_MININT64;
+  trans.gmtoff = gmtoff;
+  trans.is_dst = FALSE;
+  trans.abbr = g_time_zone_intern_abbr (abbr);
+  g_array_append_val (transitions, trans);
+
+  return g_time_zone_new_from_arrays (identifier, transitions, NULL);
+}
+
+/*
+ * Creates a zone from a POSIX TZ string such as "CET-1CEST,M3.5.0,M10.5.0/3",
+ * or %NULL if @identifier is not one.
+ */
+static GTimeZone*
+g_time_zone_new_from_rule (const gchar *identifier)
+{
+  GTimeZoneTransition  trans;
+  GTzRule              rule;
+  GArray              *transitions;
+
+  if (!g_tz_rule_parse (identifier, &rule))
+    return NULL;
+
+  transitions = g_array_sized_new (FALSE, FALSE,
+                                   sizeof (GTimeZoneTransition), 3);
+
+  trans.utc = G_MININT64;
+  trans.gmtoff = rule.std_offset;
+  trans.is_dst = FALSE;
+  trans.abbr = rule.std_abbr;
+  g_array_append_val (transitions, trans);
+
+  return g_time_zone_new_from_arrays (identifier, transitions, &rule);
+}
+
+/*
+ * Parses fixed offsets of the form "+hh", "+hhmm" or "+hh:mm".  Returns
+ * %FALSE if @identifier is not such an offset.
+ */
+static gboolean
+g_time_zone_parse_offset (const gchar *identifier,
+                          gint32      *gmtoff)
+{
+  const gchar *p = identifier;
+  gint         sign,
+               hours,
+               minutes = 0;
+
+  if (*p != '+' && *p != '-')
+    return FALSE;
+
+  sign = (*p++ == '-') ? -1 : 1;
+
+  if (!g_ascii_isdigit (p [0]) || !g_ascii_isdigit (p [1]))
+    return FALSE;
+
+  hours = (p [0] - '0') * 10 + (p [1] - '0');
+  p += 2;
+
+  if (*p == ':')
+    p++;
+
+  if (*p)
+    {
+      if (!g_ascii_isdigit (p [0]) || !g_ascii_isdigit (p [1]) || p [2])
+        return FALSE;
+      minutes = (p [0] - '0') * 10 + (p [1] - '0');
+    }
+
+  if (hours > 24 || minutes > 59)
+    return FALSE;
+
+  *gmtoff = sign * ((hours * 3600) + (minutes * 60));
+
+  return TRUE;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_TO)
+
+static GStaticMutex  watch_lock = G_STATIC_MUTEX_INIT;
+static volatile gint watch_fd = -1;
+static gint          etc_wd = -1;
+
+/*
+ * Waits for /etc/localtime or a loaded zoneinfo file to change and then
+ * refreshes every zone.  Updates of the zoneinfo package replace many files
+ * at once, so events are drained until none arrive for a second.
+ */
+static gpointer
+g_time_zone_watch_thread (gpointer data)
+{
+  union
+  {
+    struct inotify_event event;
+    gchar                bytes [4096];
+  } buf;
+  struct inotify_event *event;
+  struct pollfd         pfd;
+  gboolean              changed;
+  gssize                len,
+                        i;
+  gint                  fd = GPOINTER_TO_INT (data);
+
+  for (;;)
+    {
+      if ((len = read (fd, &buf, sizeof buf)) <= 0)
+        {
+          if (len < 0 && errno == EINTR)
+            continue;
+          break;
+        }
+
+      changed = FALSE;
+      for (i = 0; i < len; i += sizeof (struct inotify_event) + event->len)
+        {
+          event = (struct inotify_event*)(buf.bytes + i);
+
+          /* Only /etc/localtime matters among the files in /etc */
+          if (event->wd == etc_wd &&
+              (event->len == 0 || strcmp (event->name, "localtime") != 0))
+            continue;
+
+          changed = TRUE;
+        }
+
+      if (!changed)
+        continue;
+
+      pfd.fd = fd;
+      pfd.events = POLLIN;
+      while (poll (&pfd, 1, 1000) > 0)
+        if (read (fd, &buf, sizeof buf) <= 0 && errno != EINTR)
+          break;
+
+      g_time_zone_refresh ();
+    }
+
+  return NULL;
+}
+
+/*
+ * Forking while the watcher thread refreshes would leave registry_lock held
+ * in the child, so the lock is taken around fork().  The child has no
+ * watcher thread, so it closes the inherited descriptor and may start its
+ * own watch with g_time_zone_watch_start().
+ */
+static void
+g_time_zone_watch_prepare (void)
+{
+  g_static_mutex_lock (&watch_lock);
+  g_static_mutex_lock (&registry_lock);
+}
+
+static void
+g_time_zone_watch_parent (void)
+{
+  g_static_mutex_unlock (&registry_lock);
+  g_static_mutex_unlock (&watch_lock);
+}
+
+static void
+g_time_zone_watch_child (void)
+{
+  if (watch_fd >= 0)
+    close (watch_fd);
+  watch_fd = -1;
+  etc_wd = -1;
+
+  g_static_mutex_unlock (&registry_lock);
+  g_static_mutex_unlock (&watch_lock);
+}
+
+/*
+ * Watches the directory holding @filename for changes, once
+ * g_time_zone_watch_start() has been called.
+ */
+static void
+g_time_zone_watch (const gchar *filename)
+{
+  gchar  resolved [PATH_MAX];
+  gchar *dirname;
+
+  if (g_atomic_int_get (&watch_fd) < 0 || !realpath (filename, resolved))
+    return;
+
+  /* Watching the directory also sees files that are replaced by rename() */
+  dirname = g_path_get_dirname (resolved);
+
+  g_static_mutex_lock (&watch_lock);
+  if (watch_fd >= 0)
+    inotify_add_watch (watch_fd, dirname, WATCH_EVENTS);
+  g_static_mutex_unlock (&watch_lock);
+
+  g_free (dirname);
+}
+
+/**
+ * g_time_zone_watch_start:
+ *
+ * Starts a thread watching /etc/localtime and the zoneinfo files of every
+ * loaded timezone, which calls g_time_zone_refresh() once they change.
+ * Nothing is watched unless this is called.  Threads must be initialized
+ * first, and zones loaded before the call are checked again so that their
+ * files are watched too.
+ *
+ * The watch is not inherited by child processes, since they do not inherit
+ * its thread.  A pre-fork server using g_time_zone_share() calls this in
+ * each child that should notice changes.
+ *
+ * Return value: %TRUE if changes are watched, %FALSE if inotify is not
+ *   supported or could not be set up.
+ *
+ * Since: 2.26
+ */
+gboolean
+g_time_zone_watch_start (void)
+{
+  static gboolean registered = FALSE;
+  gint            fd;
+
+  g_return_val_if_fail (g_thread_supported (), FALSE);
+
+  g_static_mutex_lock (&watch_lock);
+
+  if (watch_fd >= 0)
+    {
+      g_static_mutex_unlock (&watch_lock);
+      return TRUE;
+    }
+
+  if (!registered)
+    registered = pthread_atfork (g_time_zone_watch_prepare,
+                                 g_time_zone_watch_parent,
+                                 g_time_zone_watch_child) == 0;
+
+  if ((fd = inotify_init ()) >= 0)
+    {
+      fcntl (fd, F_SETFD, FD_CLOEXEC);
+      g_atomic_int_set (&watch_fd, fd);
+      etc_wd = inotify_add_watch (fd, "/etc", WATCH_EVENTS);
+
+      if (!g_thread_create (g_time_zone_watch_thread, GINT_TO_POINTER (fd),
+                            FALSE, NULL))
+        {
+          close (fd);
+          g_atomic_int_set (&watch_fd, -1);
+        }
+    }
+
+  fd = watch_fd;
+
+  g_static_mutex_unlock (&watch_lock);
+
+  /* Zones are watched as they are loaded, so reload those loaded so far */
+  if (fd >= 0)
+    g_time_zone_refresh ();
+
+  return fd >= 0;
+}
+#else
+static void
+g_time_zone_watch (const gchar *filename)
+{
+}
+
+gboolean
+g_time_zone_watch_start (void)
+{
+  return FALSE;
+}
+#endif
+
+/*
+ * Loads the zone named by @identifier, or %NULL if it is unknown.
+ */
+static GTimeZone*
+g_time_zone_load (const gchar *identifier)
+{
+  GTimeZone *tz = NULL;
+  GTzData   *tzdata;
+  gchar     *filename;
+  gint32     gmtoff;
+
+  if (g_ascii_strcasecmp (identifier, "UTC") == 0 ||
+      g_ascii_strcasecmp (identifier, "Z") == 0)
+    return g_time_zone_new_fixed (identifier, 0, "UTC");
+
+  if (g_time_zone_parse_offset (identifier, &gmtoff))
+    return g_time_zone_new_fixed (identifier, gmtoff, identifier);
+
+  filename = g_tz_data_get_filename (identifier);
+
+  /* Files in the zoneinfo database take precedence over the snapshot */
+  if ((tzdata = g_tz_data_new_from_file (filename)))
+    g_time_zone_watch (filename);
+  else
+    tzdata = g_tz_data_new_from_builtin (identifier);
+
+  if (tzdata)
+    {
+      tz = g_time_zone_new_from_tz_data (identifier, tzdata);
+      g_tz_data_free (tzdata);
+    }
+  else
+    tz = g_time_zone_new_from_rule (identifier);
+
+  g_free (filename);
+
+  return tz;
+}
+
+/*
+ * Checks whether @a and @b were loaded from the same rules, so that a zone
+ * reloaded by g_time_zone_refresh() can be dropped in favour of the old one.
+ */
+static gboolean
+g_time_zone_equal_rules (const GTimeZone *a,
+                         const GTimeZone *b)
+{
+  const GTimeZoneTransition *ta,
+                            *tb;
+  guint                      i;
+
+  if (strcmp (a->identifier, b->identifier) != 0 ||
+      a->n_transitions != b->n_transitions ||
+      a->n_intervals != b->n_intervals ||
+      !a->rule != !b->rule)
+    return FALSE;
+
+  for (i = 0; i < a->n_intervals; i++)
+    {
+      ta = &a->transitions [i];
+      tb = &b->transitions [i];
+      if (ta->utc != tb->utc || ta->gmtoff != tb->gmtoff ||
+          !ta->is_dst != !tb->is_dst || g_strcmp0 (ta->abbr, tb->abbr) != 0)
+        return FALSE;
+    }
+
+  return !a->rule ||
+         (a->rule->std_offset == b->rule->std_offset &&
+          a->rule->dst_offset == b->rule->dst_offset &&
+          !a->rule->has_dst == !b->rule->has_dst &&
+          g_strcmp0 (a->rule->std_abbr, b->rule->std_abbr) == 0 &&
+          g_strcmp0 (a->rule->dst_abbr, b->rule->dst_abbr) == 0 &&
+          memcmp (&a->rule->start, &b->rule->start,
+                  sizeof (GTzRuleDate)) == 0 &&
+          memcmp (&a->rule->end, &b->rule->end,
+                  sizeof (GTzRuleDate)) == 0);
+}
+
+static GTimeZoneRegistry*
+g_time_zone_registry_new (guint size)
+{
+  GTimeZoneRegistry *reg;
+
+  reg = g_new0 (GTimeZoneRegistry, 1);
+  reg->size = size;
+  reg->zones = g_new0 (GTimeZone*, size / 2);
+  reg->generations = g_new0 (gint, size / 2);
+  reg->slots = g_new0 (gint, size);
+
+  return reg;
+}
+
+/*
+ * Finds the zone named @identifier within @reg without taking any locks.
+ */
+static GTimeZone*
+g_time_zone_registry_lookup (GTimeZoneRegistry *reg,
+                             const gchar       *identifier,
+                             guint              hash)
+{
+  GTimeZone *tz;
+  guint      i;
+  gint       id;
+
+  if (!reg)
+    return NULL;
+
+  for (i = hash & (reg->size - 1);
+       (id = g_atomic_int_get (&reg->slots [i])) != 0;
+       i = (i + 1) & (reg->size - 1))
+    {
+      /* Changed zones are replaced, see g_time_zone_registry_update() */
+      tz = g_atomic_pointer_get ((gpointer*)&reg->zones [id - 1]);
+      if (strcmp (tz->identifier, identifier) == 0)
+        return tz;
+    }
+
+  return NULL;
+}
+
+/*
+ * Publishes a private copy of the registry with @size slots, retiring the
+ * current one.  Must be called with registry_lock held.
+ */
+static GTimeZoneRegistry*
+g_time_zone_registry_copy (guint size)
+{
+  GTimeZoneRegistry *reg = registry,
+                    *copy;
+  guint              i,
+                     id;
+
+  copy = g_time_zone_registry_new (size);
+
+  if (reg)
+    for (id = 0; id < reg->n_zones; id++)
+      {
+        copy->zones [id] = reg->zones [id];
+        copy->generations [id] = reg->generations [id];
+        for (i = g_str_hash (reg->zones [id]->identifier) & (copy->size - 1);
+             copy->slots [i] != 0;
+             i = (i + 1) & (copy->size - 1));
+        copy->slots [i] = id + 1;
+      }
+
+  copy->n_zones = reg ? reg->n_zones : 0;
+  g_atomic_pointer_set ((gpointer*)&registry, copy);
+
+  return copy;
+}
+
+/*
+ * Adds @tz to the registry, growing it if needed.  Must be called with
+ * registry_lock held.
+ */
+static void
+g_time_zone_registry_insert (GTimeZone *tz,
+                             guint      hash,
+                             gint       generation_)
+{
+  GTimeZoneRegistry *reg = registry;
+  guint              i;
+
+  /* Keep the load factor at or below one half, and never write to a copy
+   * shared between processes */
+  if (!reg || reg->shared || reg->n_zones == reg->size / 2)
+    reg = g_time_zone_registry_copy (reg ? reg->size * 2 : 64);
+
+  tz->permanent = TRUE;
+  tz->id = reg->n_zones++;
+  reg->zones [tz->id] = tz;
+  reg->generations [tz->id] = generation_;
+
+  for (i = hash & (reg->size - 1);
+       reg->slots [i] != 0;
+       i = (i + 1) & (reg->size - 1));
+
+  /* Publishing the slot is a full barrier, so readers see the zone first */
+  g_atomic_int_set (&reg->slots [i], tz->id + 1);
+}
+
+/*
+ * Checks @tz, registered in an older generation, against @loaded, which was
+ * loaded in @generation_.  @tz is kept if its rules are unchanged, otherwise
+ * @loaded takes over its id.  Returns the zone now registered.  Must be
+ * called with registry_lock held.
+ */
+static GTimeZone*
+g_time_zone_registry_update (GTimeZone *tz,
+                             GTimeZone *loaded,
+                             gint       generation_)
+{
+  GTimeZoneRegistry *reg = registry;
+
+  if (reg->shared)
+    reg = g_time_zone_registry_copy (reg->size);
+
+  if (!g_time_zone_equal_rules (tz, loaded))
+    {
+      loaded->permanent = TRUE;
+      loaded->id = tz->id;
+      g_atomic_pointer_set ((gpointer*)&reg->zones [tz->id], loaded);
+      tz = loaded;
+    }
+
+  g_atomic_int_set (&reg->generations [tz->id], generation_);
+
+  return tz;
+}
+
+/*
+ * Gives @tz the next index, growing the table if needed.  Must be called
+ * with index_lock held.
+ */
+static void
+g_time_zone_index_insert (GTimeZone *tz)
+{
+  GTimeZoneIndex *table = zone_index,
+                 *grown;
+
+  if (!table || (guint)table->n_zones == table->size)
+    {
+      grown = g_new0 (GTimeZoneIndex, 1);
+      grown->size = table ? table->size * 2 : 64;
+      grown->zones = g_new0 (GTimeZone*, grown->size);
+      grown->n_zones = table ? table->n_zones : 1;
+
+      if (table)
+        memcpy (grown->zones, table->zones, table->n_zones * sizeof (GTimeZone*));
+
+      g_atomic_pointer_set ((gpointer*)&zone_index, grown);
+      table = grown;
+    }
+
+  /* Indexed zones may be looked up at any time, so are never freed */
+  tz->permanent = TRUE;
+  table->zones [table->n_zones] = tz;
+  g_atomic_int_set (&table->n_zones, table->n_zones + 1);
+
+  /* Publishing the index is a full barrier, so readers see the zone and
+   * the count covering it first */
+  g_atomic_int_set (&tz->index, table->n_zones - 1);
+}
+
+static void
+g_time_zone_free (GTimeZone *tz)
+{
+  g_static_mutex_lock (&cache_lock);
+  cache_stats.n_zones--;
+  cache_stats.n_bytes -= g_time_zone_get_size (tz);
+  g_static_mutex_unlock (&cache_lock);
+
+  if (tz->rule)
+    g_slice_free (GTzRule, tz->rule);
+
+  g_free (tz->identifier);
+  g_free (tz->transitions);
+  g_slice_free (GTimeZone, tz);
+}
+
+/**
+ * g_time_zone_new:
+ * @identifier: the name of a timezone such as "Europe/Berlin", "UTC",
+ *   a fixed offset such as "+05:30", or %NULL for the local timezone
+ *
+ * Retrieves the timezone named by @identifier.  Names are looked up in the
+ * zoneinfo database, which is found in $TZDIR or /usr/share/zoneinfo.
+ *
+ * Each timezone is only loaded once per process, and checked again after
+ * g_time_zone_refresh().  Later calls with the same @identifier return the
+ * same immutable #GTimeZone, unless a refresh found its rules changed, and
+ * are safe to make from many threads at once since they take no locks.
+ * Loading a zone does not block threads retrieving other zones either, see
+ * g_date_time_warm_up() to load zones ahead of time.
+ *
+ * Return value: the #GTimeZone which should be released with
+ *   g_time_zone_unref(), or %NULL if @identifier is not a known timezone.
+ *
+ * Since: 2.26
+ */
+GTimeZone*
+g_time_zone_new (const gchar *identifier) /* IN */
+{
+  GTimeZoneRegistry *reg;
+  GTimeZone         *tz,
+                    *loaded;
+  guint              hash;
+  gint               current;
+
+  if (identifier == NULL)
+    return g_time_zone_new_local ();
+
+  hash = g_str_hash (identifier);
+
+  /* Read the generation before the registry, so a zone checked in the
+   * current generation is never older than the last refresh */
+  current = g_atomic_int_get (&generation);
+  reg = g_atomic_pointer_get ((gpointer*)&registry);
+  if ((tz = g_time_zone_registry_lookup (reg, identifier, hash)) &&
+      g_atomic_int_get (&reg->generations [tz->id]) == current)
+    return tz;
+
+  if (!(loaded = g_time_zone_load (identifier)))
+    return NULL;
+
+  g_static_mutex_lock (&registry_lock);
+
+  /* Another thread may have registered or checked the zone while we loaded
+   * it, possibly in a later generation */
+  if (!(tz = g_time_zone_registry_lookup (registry, identifier, hash)))
+    {
+      g_time_zone_registry_insert (loaded, hash, current);
+      tz = loaded;
+      loaded = NULL;
+    }
+  else if (registry->generations [tz->id] - current < 0)
+    {
+      tz = g_time_zone_registry_update (tz, loaded, current);
+      if (tz == loaded)
+        loaded = NULL;
+    }
+
+  g_static_mutex_unlock (&registry_lock);
+
+  if (loaded)
+    g_time_zone_free (loaded);
+
+  return tz;
+}
+
+/**
+ * g_time_zone_new_local:
+ *
+ * Retrieves the timezone of the process.  This is the zone named by $TZ, or
+ * /etc/localtime if $TZ is not set.  The zone is loaded once, and again
+ * after g_time_zone_refresh().  Zones pushed by the calling thread with
+ * g_time_zone_push_thread_default() are not taken into account.
+ *
+ * Return value: the local #GTimeZone which should be released with
+ *   g_time_zone_unref().
+ *
+ * Since: 2.26
+ */
+GTimeZone*
+g_time_zone_new_local (void)
+{
+  GTimeZone   *tz,
+              *loaded,
+              *retired;
+  GTzData     *tzdata;
+  const gchar *identifier;
+  gboolean     registered;
+
+  while (!(tz = g_atomic_pointer_get ((gpointer*)&local_zone)))
+    {
+      loaded = NULL;
+
+      if ((identifier = g_time_zone_get_local_identifier ()))
+        loaded = g_time_zone_new (identifier);
+      else
+        {
+          identifier = "localtime";
+          if ((tzdata = g_tz_data_new_from_file ("/etc/localtime")))
+            g_time_zone_watch ("/etc/localtime");
+          else
+            /* libc uses UTC when /etc/localtime is missing */
+            tzdata = g_tz_data_new_from_builtin ("UTC");
+
+          if (tzdata)
+            {
+              loaded = g_time_zone_new_from_tz_data (identifier, tzdata);
+              g_tz_data_free (tzdata);
+            }
+        }
+
+      if (!loaded)
+        loaded = g_time_zone_new_from_libc (identifier);
+
+      /* Keep the zone forgotten by a refresh if it did not change */
+      retired = g_atomic_pointer_get ((gpointer*)&retired_local_zone);
+      if (!loaded->permanent && retired &&
+          g_time_zone_equal_rules (retired, loaded))
+        {
+          g_time_zone_free (loaded);
+          loaded = retired;
+        }
+
+      /* Zones from g_time_zone_new() are registered and already shared */
+      if (!(registered = loaded->permanent))
+        loaded->permanent = TRUE;
+
+      if (g_atomic_pointer_compare_and_exchange ((gpointer*)&local_zone,
+                                                 NULL, loaded))
+        return loaded;
+
+      /* Another thread published the local zone first */
+      if (!registered)
+        g_time_zone_free (loaded);
+    }
+
+  return tz;
+}
+
+/**
+ * g_time_zone_new_utc:
+ *
+ * Retrieves the timezone for Universal coordinated time.
+ *
+ * Return value: the UTC #GTimeZone which should be released with
+ *   g_time_zone_unref().
+ *
+ * Since: 2.26
+ */
+GTimeZone*
+g_time_zone_new_utc (void)
+{
+  return g_time_zone_new ("UTC");
+}
+
+static void
+g_time_zone_defaults_free (gpointer data)
+{
+  GPtrArray *defaults = data;
+  guint      i;
+
+  for (i = 0; i < defaults->len; i++)
+    g_time_zone_unref (g_ptr_array_index (defaults, i));
+
+  g_ptr_array_free (defaults, TRUE);
+}
+
+/**
+ * g_time_zone_push_thread_default:
+ * @tz: a #GTimeZone
+ *
+ * Makes @tz the local timezone of the calling thread until the matching
+ * g_time_zone_pop_thread_default().  Wall clock times created by
+ * g_date_time_now(), g_date_time_new_full() and g_date_time_to_local() in
+ * this thread are then in @tz rather than in the timezone of the process,
+ * and keep @tz once it is popped.  Other threads are not affected, and no
+ * locks are taken, so a thread serving many users may push the timezone
+ * of each in turn.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_push_thread_default (GTimeZone *tz) /* IN */
+{
+  GPtrArray *defaults;
+
+  g_return_if_fail (tz != NULL);
+
+  if (!(defaults = g_static_private_get (&defaults_key)))
+    {
+      defaults = g_ptr_array_new ();
+      g_static_private_set (&defaults_key, defaults, g_time_zone_defaults_free);
+    }
+
+  g_ptr_array_add (defaults, g_time_zone_ref (tz));
+}
+
+/**
+ * g_time_zone_pop_thread_default:
+ * @tz: the #GTimeZone last pushed by the calling thread
+ *
+ * Undoes g_time_zone_push_thread_default(), restoring the timezone the
+ * calling thread used before.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_pop_thread_default (GTimeZone *tz) /* IN */
+{
+  GPtrArray *defaults;
+
+  defaults = g_static_private_get (&defaults_key);
+
+  g_return_if_fail (defaults != NULL && defaults->len > 0);
+  g_return_if_fail (g_ptr_array_index (defaults, defaults->len - 1) == tz);
+
+  g_ptr_array_remove_index (defaults, defaults->len - 1);
+  g_time_zone_unref (tz);
+}
+
+/**
+ * g_time_zone_get_thread_default:
+ *
+ * Retrieves the timezone last pushed by the calling thread with
+ * g_time_zone_push_thread_default().
+ *
+ * Return value: the #GTimeZone, owned by the thread, or %NULL if the
+ *   calling thread uses the timezone of the process.
+ *
+ * Since: 2.26
+ */
+GTimeZone*
+g_time_zone_get_thread_default (void)
+{
+  GPtrArray *defaults;
+
+  defaults = g_static_private_get (&defaults_key);
+
+  if (!defaults || defaults->len == 0)
+    return NULL;
+
+  return g_ptr_array_index (defaults, defaults->len - 1);
+}
+
+/**
+ * g_time_zone_refresh:
+ *
+ * Forgets every loaded timezone, and the table of leap seconds, so that the
+ * next call to g_time_zone_new() or g_time_zone_new_local() loads it again.
+ * Call this after changing $TZ or the zoneinfo database.  Changes to
+ * /etc/localtime and to loaded zoneinfo files are noticed automatically
+ * after g_time_zone_watch_start().
+ *
+ * Zones whose rules did not change are kept, so refreshing costs no memory
+ * unless the database did change.  Zones retrieved before the refresh remain
+ * valid, since zones are never freed, but keep describing the old rules.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_refresh (void)
+{
+  GTimeZone  *local;
+  GLeapTable *leaps;
+
+  g_static_mutex_lock (&registry_lock);
+
+  g_atomic_int_inc (&generation);
+
+  if ((local = g_atomic_pointer_get ((gpointer*)&local_zone)))
+    g_atomic_pointer_set ((gpointer*)&retired_local_zone, local);
+  if ((leaps = g_atomic_pointer_get ((gpointer*)&leap_table)))
+    g_atomic_pointer_set ((gpointer*)&retired_leap_table, leaps);
+
+  g_atomic_pointer_set ((gpointer*)&local_zone, NULL);
+  g_atomic_pointer_set ((gpointer*)&leap_table, NULL);
+
+  g_static_mutex_unlock (&registry_lock);
+}
+
+/**
+ * g_time_zone_get_cache_stats:
+ * @n_zones: a location for the number of zones, or %NULL
+ * @n_abbreviations: a location for the number of abbreviations, or %NULL
+ * @n_bytes: a location for the number of bytes, or %NULL
+ *
+ * Retrieves how many timezones are held in memory, how many distinct
+ * abbreviations they share, and how many bytes both take up.  Zones replaced
+ * by g_time_zone_refresh() are still counted since they are never freed.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_get_cache_stats (guint *n_zones,         /* OUT */
+                             guint *n_abbreviations, /* OUT */
+                             gsize *n_bytes)         /* OUT */
+{
+  g_static_mutex_lock (&cache_lock);
+
+  if (n_zones)
+    *n_zones = cache_stats.n_zones;
+  if (n_abbreviations)
+    *n_abbreviations = cache_stats.n_abbreviations;
+  if (n_bytes)
+    *n_bytes = cache_stats.n_bytes;
+
+  g_static_mutex_unlock (&cache_lock);
+}
+
+/**
+ * g_time_zone_ref:
+ * @tz: a #GTimeZone
+ *
+ * Atomically increments the reference count of @tz by one.  Zones
+ * returned by g_time_zone_new() live for the whole process and are not
+ * reference counted, so this is free for them.
+ *
+ * Return value: @tz
+ *
+ * Since: 2.26
+ */
+GTimeZone*
+g_time_zone_ref (GTimeZone *tz) /* IN */
+{
+  g_return_val_if_fail (tz != NULL, NULL);
+
+  /* Avoid bouncing the cache line of shared zones between threads */
+  if (tz->permanent)
+    return tz;
+
+  g_return_val_if_fail (tz->ref_count > 0, NULL);
+
+  g_atomic_int_inc (&tz->ref_count);
+
+  return tz;
+}
+
+/**
+ * g_time_zone_unref:
+ * @tz: a #GTimeZone
+ *
+ * Atomically decrements the reference count of @tz by one.  When the
+ * reference count reaches zero, the zone is freed.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_unref (GTimeZone *tz) /* IN */
+{
+  g_return_if_fail (tz != NULL);
+
+  if (tz->permanent)
+    return;
+
+  g_return_if_fail (tz->ref_count > 0);
+
+  if (g_atomic_int_dec_and_test (&tz->ref_count))
+    g_time_zone_free (tz);
+}
+
+/**
+ * g_time_zone_get_index:
+ * @tz: a #GTimeZone
+ *
+ * Retrieves a small number identifying @tz, given out the first time it is
+ * asked for, so that @tz can be stored in a few bits and found again with
+ * g_time_zone_lookup_index().  Indices are never reused, and @tz is kept
+ * for the rest of the process once it has one.
+ *
+ * Return value: the index of @tz, never 0
+ *
+ * Since: 2.26
+ */
+guint
+g_time_zone_get_index (GTimeZone *tz) /* IN */
+{
+  gint index_;
+
+  g_return_val_if_fail (tz != NULL, 0);
+
+  if (G_LIKELY ((index_ = g_atomic_int_get (&tz->index))))
+    return index_;
+
+  g_static_mutex_lock (&index_lock);
+
+  if (!tz->index)
+    g_time_zone_index_insert (tz);
+  index_ = tz->index;
+
+  g_static_mutex_unlock (&index_lock);
+
+  return index_;
+}
+
+/**
+ * g_time_zone_lookup_index:
+ * @index_: an index returned by g_time_zone_get_index()
+ *
+ * Retrieves the timezone given @index_ by g_time_zone_get_index(), without
+ * taking any locks.
+ *
+ * Return value: the #GTimeZone, which is never freed and need not be
+ *   released
+ *
+ * Since: 2.26
+ */
+GTimeZone*
+g_time_zone_lookup_index (guint index_) /* IN */
+{
+  GTimeZoneIndex *table;
+
+  table = g_atomic_pointer_get ((gpointer*)&zone_index);
+
+  g_return_val_if_fail (table != NULL, NULL);
+  g_return_val_if_fail (index_ > 0 &&
+                        index_ < (guint)g_atomic_int_get (&table->n_zones),
+                        NULL);
+
+  return table->zones [index_];
+}
+
+/**
+ * g_time_zone_get_identifier:
+ * @tz: a #GTimeZone
+ *
+ * Retrieves the name @tz was created with, such as "Europe/Berlin".
+ *
+ * Return value: the identifier of @tz, owned by @tz
+ *
+ * Since: 2.26
+ */
+const gchar*
+g_time_zone_get_identifier (GTimeZone *tz) /* IN */
+{
+  g_return_val_if_fail (tz != NULL, NULL);
+  return tz->identifier;
+}
+
+/*
+ * Finds the interval of @tz containing the instant @utc, in seconds since
+ * the Epoch, using a binary search over the transition table.
+ */
+static guint
+g_time_zone_find (GTimeZone *tz,
+                  gint64     utc,
+                  gint64    *start,
+                  gint64    *end)
+{
+  gint64 rule_start;
+  guint lo = 0,
+        hi = tz->n_transitions,
+        mid;
+
+  /* The first transition is at G_MININT64, so lo never drops below 1. */
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (tz->transitions [mid].utc <= utc)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  *start = tz->transitions [lo - 1].utc;
+  *end = (lo < tz->n_transitions) ? tz->transitions [lo].utc : G_MAXINT64;
+
+  /* The rule, if any, takes over after the last transition */
+  if (tz->rule && lo == tz->n_transitions)
+    {
+      rule_start = *start;
+      lo = tz->n_transitions
+         + g_tz_rule_is_dst (tz->rule, G_TIME_TYPE_UNIVERSAL, utc, start, end);
+      *start = MAX (*start, rule_start);
+
+      return lo;
+    }
+
+  return lo - 1;
+}
+
+/*
+ * Like g_time_zone_find() but @local is a wall clock time in seconds since
+ * the Epoch.  Times skipped at the start of daylight savings resolve to the
+ * earlier interval, and repeated times at its end to the later interval.
+ */
+static guint
+g_time_zone_find_local (GTimeZone *tz,
+                        gint64     local,
+                        gint64    *start,
+                        gint64    *end)
+{
+  gint64 rule_start;
+  guint lo = 1,
+        hi = tz->n_transitions,
+        mid;
+
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (tz->transitions [mid].utc + tz->transitions [mid].gmtoff <= local)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  /* The first interval has no beginning, so avoid overflowing */
+  if (lo > 1)
+    *start = tz->transitions [lo - 1].utc + tz->transitions [lo - 1].gmtoff;
+  else
+    *start = G_MININT64;
+
+  if (lo < tz->n_transitions)
+    *end = tz->transitions [lo].utc + tz->transitions [lo].gmtoff;
+  else
+    *end = G_MAXINT64;
+
+  if (tz->rule && lo == tz->n_transitions)
+    {
+      rule_start = *start;
+      lo = tz->n_transitions
+         + g_tz_rule_is_dst (tz->rule, G_TIME_TYPE_LOCAL, local, start, end);
+      *start = MAX (*start, rule_start);
+
+      return lo;
+    }
+
+  return lo - 1;
+}
+
+/**
+ * g_time_zone_find_interval:
+ * @tz: a #GTimeZone
+ * @type: the #GTimeType of @time_
+ * @time_: a time in seconds since the Epoch
+ *
+ * Finds the interval of @tz that @time_ falls within.  The interval can be
+ * passed to g_time_zone_get_offset() and friends.  The lookup is a binary
+ * search over the transitions of @tz, unless @time_ falls within the same
+ * interval as the previous lookup of the calling thread.
+ *
+ * For %G_TIME_TYPE_LOCAL, wall clock times that are skipped at the start of
+ * daylight savings resolve to the interval before the transition, and times
+ * that are repeated at its end resolve to the interval after it.
+ *
+ * Return value: the interval containing @time_
+ *
+ * Since: 2.26
+ */
+gint
+g_time_zone_find_interval (GTimeZone *tz,    /* IN */
+                           GTimeType  type,  /* IN */
+                           gint64     time_) /* IN */
+{
+  GTimeZoneWindow *windows,
+                  *window;
+  gint64           start,
+                   end;
+  gint             interval;
+
+  g_return_val_if_fail (tz != NULL, 0);
+
+  if (!(windows = g_static_private_get (&windows_key)))
+    {
+      windows = g_new0 (GTimeZoneWindow, 2);
+      g_static_private_set (&windows_key, windows, g_free);
+    }
+
+  window = &windows [type == G_TIME_TYPE_LOCAL];
+
+  if (window->tz == tz && window->start <= time_ && time_ < window->end)
+    return window->interval;
+
+  if (type == G_TIME_TYPE_LOCAL)
+    interval = g_time_zone_find_local (tz, time_, &start, &end);
+  else
+    interval = g_time_zone_find (tz, time_, &start, &end);
+
+  if (tz->permanent)
+    {
+      window->tz = tz;
+      window->start = start;
+      window->end = end;
+      window->interval = interval;
+    }
+
+  return interval;
+}
+
+/**
+ * g_time_zone_convert_times:
+ * @tz: a #GTimeZone
+ * @type: the #GTimeType of @times
+ * @times: an array of times in seconds since the Epoch
+ * @converted: an array of @n_times for the results, which may be @times
+ * @n_times: the number of times to convert
+ *
+ * Converts each instant in @times to the wall clock time in @tz when @type
+ * is %G_TIME_TYPE_UNIVERSAL, or each wall clock time in @tz to an instant
+ * when @type is %G_TIME_TYPE_LOCAL, choosing the interval as
+ * g_time_zone_find_interval() does.
+ *
+ * Runs of times within the same interval are converted together, so
+ * sorted input costs one search per interval it spans rather than one per
+ * time.  Unsorted input falls back to a binary search for each time.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_convert_times (GTimeZone    *tz,        /* IN */
+                           GTimeType     type,      /* IN */
+                           const gint64 *times,     /* IN */
+                           gint64       *converted, /* OUT */
+                           gsize         n_times)   /* IN */
+{
+  gint64 start = 0,
+         end = 0,
+         offset = 0;
+  gsize  i,
+         j;
+  guint  interval;
+
+  g_return_if_fail (tz != NULL);
+  g_return_if_fail (n_times == 0 || (times != NULL && converted != NULL));
+
+  for (i = 0; i < n_times; i = j)
+    {
+      if (times [i] < start || times [i] >= end)
+        {
+          if (type == G_TIME_TYPE_LOCAL)
+            interval = g_time_zone_find_local (tz, times [i], &start, &end);
+          else
+            interval = g_time_zone_find (tz, times [i], &start, &end);
+
+          offset = tz->transitions [interval].gmtoff;
+          if (type == G_TIME_TYPE_LOCAL)
+            offset = -offset;
+        }
+
+      /* Convert the run of times within the interval.  The interval of the
+       * first may end at G_MAXINT64, which is not within it. */
+      converted [i] = times [i] + offset;
+      for (j = i + 1; j < n_times && start <= times [j] && times [j] < end; j++)
+        converted [j] = times [j] + offset;
+    }
+}
+
+/*
+ * The instants at which each local calendar day of a range begins, so that
+ * events can be grouped by day without converting each to a wall clock time.
+ */
+struct _GTimeZoneDays
+{
+  guint   n_days;
+  gint64 *midnights;            /* Start of each day, then the end of the last */
+};
+
+/**
+ * g_time_zone_days_new:
+ * @tz: a #GTimeZone
+ * @first: the first instant of the range, in seconds since the Epoch
+ * @last: the last instant of the range, in seconds since the Epoch
+ *
+ * Computes when each calendar day in @tz begins, from the day containing
+ * @first through the day containing @last.  Days begin at local midnight,
+ * or at the transition when midnight is skipped, so they are 23 or 25
+ * hours long when daylight savings begins or ends, and may even be empty.
+ *
+ * Return value: the days, which should be freed with
+ *   g_time_zone_days_free().
+ *
+ * Since: 2.26
+ */
+GTimeZoneDays*
+g_time_zone_days_new (GTimeZone *tz,    /* IN */
+                      gint64     first, /* IN */
+                      gint64     last)  /* IN */
+{
+  GTimeZoneDays *days;
+  gint64         first_day,
+                 last_day,
+                 later;
+  guint          i;
+
+  g_return_val_if_fail (tz != NULL, NULL);
+  g_return_val_if_fail (first <= last, NULL);
+
+  first_day = g_tz_floor_div (first + g_time_zone_get_offset (tz,
+                                g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                                           first)),
+                              SEC_PER_DAY);
+  last_day = g_tz_floor_div (last + g_time_zone_get_offset (tz,
+                               g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                                          last)),
+                             SEC_PER_DAY);
+
+  g_return_val_if_fail (last_day - first_day < G_MAXINT, NULL);
+
+  days = g_slice_new (GTimeZoneDays);
+  days->n_days = last_day - first_day + 1;
+  days->midnights = g_new (gint64, days->n_days + 1);
+
+  /* Repeated midnights begin the day at the earlier instant */
+  for (i = 0; i <= days->n_days; i++)
+    g_time_zone_find_instants (tz, (first_day + i) * SEC_PER_DAY,
+                               &days->midnights [i], &later);
+
+  return days;
+}
+
+/**
+ * g_time_zone_days_free:
+ * @days: a #GTimeZoneDays
+ *
+ * Frees @days.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_days_free (GTimeZoneDays *days) /* IN */
+{
+  g_return_if_fail (days != NULL);
+
+  g_free (days->midnights);
+  g_slice_free (GTimeZoneDays, days);
+}
+
+/**
+ * g_time_zone_days_get_n_days:
+ * @days: a #GTimeZoneDays
+ *
+ * Retrieves the number of calendar days in @days.
+ *
+ * Return value: the number of days
+ *
+ * Since: 2.26
+ */
+guint
+g_time_zone_days_get_n_days (GTimeZoneDays *days) /* IN */
+{
+  g_return_val_if_fail (days != NULL, 0);
+  return days->n_days;
+}
+
+/**
+ * g_time_zone_days_get_start:
+ * @days: a #GTimeZoneDays
+ * @day: the index of a day, up to the number of days
+ *
+ * Retrieves the instant day @day of @days begins.  Day 0 is the day
+ * containing the first instant of the range, and the day after the last
+ * may be given to find when the range ends.
+ *
+ * Return value: the instant in seconds since the Epoch
+ *
+ * Since: 2.26
+ */
+gint64
+g_time_zone_days_get_start (GTimeZoneDays *days, /* IN */
+                            guint          day)  /* IN */
+{
+  g_return_val_if_fail (days != NULL, 0);
+  g_return_val_if_fail (day <= days->n_days, 0);
+
+  return days->midnights [day];
+}
+
+/**
+ * g_time_zone_days_find:
+ * @days: a #GTimeZoneDays
+ * @utc: an instant in seconds since the Epoch
+ *
+ * Finds the calendar day of @days containing @utc, in constant time.
+ *
+ * Return value: the index of the day, or -1 if @utc is outside the range
+ *
+ * Since: 2.26
+ */
+gint
+g_time_zone_days_find (GTimeZoneDays *days, /* IN */
+                       gint64         utc)  /* IN */
+{
+  gint day = -1;
+
+  g_return_val_if_fail (days != NULL, -1);
+
+  g_time_zone_days_find_times (days, &utc, &day, 1);
+
+  return day;
+}
+
+/**
+ * g_time_zone_days_find_times:
+ * @days: a #GTimeZoneDays
+ * @times: an array of instants in seconds since the Epoch
+ * @indices: an array of @n_times for the index of each day, or -1
+ * @n_times: the number of instants
+ *
+ * Like g_time_zone_days_find() for each of @times.
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_days_find_times (GTimeZoneDays *days,    /* IN */
+                             const gint64  *times,   /* IN */
+                             gint          *indices, /* OUT */
+                             gsize          n_times) /* IN */
+{
+  const gint64 *midnights;
+  gint64        day;
+  gsize         i;
+
+  g_return_if_fail (days != NULL);
+  g_return_if_fail (n_times == 0 || (times != NULL && indices != NULL));
+
+  midnights = days->midnights;
+
+  for (i = 0; i < n_times; i++)
+    {
+      if (times [i] < midnights [0] || times [i] >= midnights [days->n_days])
+        {
+          indices [i] = -1;
+          continue;
+        }
+
+      /* Guess assuming days of 24 hours, multiplying since that is much
+       * cheaper than a 64-bit division, then correct the guess by the few
+       * days that shorter and longer days add up to */
+      day = MIN ((gint64)((times [i] - midnights [0]) * (1.0 / SEC_PER_DAY)),
+                 (gint64)days->n_days - 1);
+
+      while (midnights [day] > times [i])
+        day--;
+      while (midnights [day + 1] <= times [i])
+        day++;
+
+      indices [i] = day;
+    }
+}
+
+/*
+ * Retrieves the offset from UTC of @tz at the instant @utc, along with the
+ * instant the interval containing @utc begins.
+ */
+static gint32
+g_time_zone_get_offset_at (GTimeZone *tz,
+                           gint64     utc,
+                           gint64    *start)
+{
+  gint64 end;
+
+  return tz->transitions [g_time_zone_find (tz, utc, start, &end)].gmtoff;
+}
+
+/**
+ * g_time_zone_find_instants:
+ * @tz: a #GTimeZone
+ * @local: a wall clock time in seconds since the Epoch
+ * @earlier: a location for the earlier instant
+ * @later: a location for the later instant
+ *
+ * Finds the instants at which the wall clock in @tz shows @local.  This is
+ * usually a single instant, stored in both @earlier and @later.  When
+ * daylight savings ends, wall clock times within the repeated hour occur
+ * at two instants.  When it begins, wall clock times within the skipped
+ * hour never occur, and the instant of the transition is stored instead.
+ *
+ * Only the transitions of @tz are consulted, not the C library.
+ * Transitions are assumed to be more than a day apart.
+ *
+ * Return value: the number of instants showing @local, which is 0, 1 or 2
+ *
+ * Since: 2.26
+ */
+gint
+g_time_zone_find_instants (GTimeZone *tz,      /* IN */
+                           gint64     local,   /* IN */
+                           gint64    *earlier, /* OUT */
+                           gint64    *later)   /* OUT */
+{
+  gint64 candidates [2],
+         start;
+  gint32 offset_before,
+         offset_after;
+  gint   n_candidates = 0;
+
+  g_return_val_if_fail (tz != NULL, 0);
+  g_return_val_if_fail (earlier != NULL, 0);
+  g_return_val_if_fail (later != NULL, 0);
+
+  offset_before = g_time_zone_get_offset_at (tz, local - SEC_PER_DAY, &start);
+  offset_after = g_time_zone_get_offset_at (tz, local + SEC_PER_DAY, &start);
+
+  if (offset_before == offset_after)
+    {
+      *earlier = *later = local - offset_before;
+      return 1;
+    }
+
+  /* Each offset gives a candidate, which is only real if that offset is
+   * actually in effect at the candidate instant. */
+  if (g_time_zone_get_offset_at (tz, local - offset_before, &start) == offset_before)
+    candidates [n_candidates++] = local - offset_before;
+
+  if (g_time_zone_get_offset_at (tz, local - offset_after, &start) == offset_after)
+    candidates [n_candidates++] = local - offset_after;
+
+  switch (n_candidates)
+    {
+    case 2:
+      *earlier = MIN (candidates [0], candidates [1]);
+      *later = MAX (candidates [0], candidates [1]);
+      break;
+
+    case 1:
+      *earlier = *later = candidates [0];
+      break;
+
+    default:
+      /* Skipped, so interpreting @local with the old offset lands just
+       * after the transition, within the interval it begins. */
+      g_time_zone_get_offset_at (tz, local - offset_before, &start);
+      *earlier = *later = start;
+      break;
+    }
+
+  return n_candidates;
+}
+
+/**
+ * g_time_zone_resolve_local:
+ * @tz: a #GTimeZone
+ * @local: a wall clock time in seconds since the Epoch
+ * @resolve: how to handle wall clock times that are repeated or skipped
+ * @utc: a location for the instant
+ *
+ * Converts @local, a wall clock time in @tz, into an instant using @resolve
+ * to choose between the instants found by g_time_zone_find_instants().
+ *
+ * Return value: %TRUE if @utc was set, or %FALSE if @resolve is
+ *   %G_TIME_RESOLVE_REJECT and @local is repeated or skipped.
+ *
+ * Since: 2.26
+ */
+gboolean
+g_time_zone_resolve_local (GTimeZone    *tz,      /* IN */
+                           gint64        local,   /* IN */
+                           GTimeResolve  resolve, /* IN */
+                           gint64       *utc)     /* OUT */
+{
+  gint64 earlier,
+         later,
+         start;
+  gint   n_instants;
+
+  g_return_val_if_fail (tz != NULL, FALSE);
+  g_return_val_if_fail (utc != NULL, FALSE);
+
+  n_instants = g_time_zone_find_instants (tz, local, &earlier, &later);
+
+  if (n_instants == 1)
+    {
+      *utc = earlier;
+      return TRUE;
+    }
+
+  switch (resolve)
+    {
+    case G_TIME_RESOLVE_EARLIER:
+      if (n_instants == 0)
+        *utc = local - g_time_zone_get_offset_at (tz, earlier, &start);
+      else
+        *utc = earlier;
+      return TRUE;
+
+    case G_TIME_RESOLVE_LATER:
+      if (n_instants == 0)
+        *utc = local - g_time_zone_get_offset_at (tz, earlier - 1, &start);
+      else
+        *utc = later;
+      return TRUE;
+
+    case G_TIME_RESOLVE_SHIFT_FORWARD:
+      *utc = earlier;
+      return TRUE;
+
+    case G_TIME_RESOLVE_REJECT:
+    default:
+      return FALSE;
+    }
+}
+
+/**
+ * g_time_zone_get_offset:
+ * @tz: a #GTimeZone
+ * @interval: an interval from g_time_zone_find_interval()
+ *
+ * Retrieves the offset from UTC in effect during @interval.
+ *
+ * Return value: the offset from UTC in seconds
+ *
+ * Since: 2.26
+ */
+gint32
+g_time_zone_get_offset (GTimeZone *tz,       /* IN */
+                        gint       interval) /* IN */
+{
+  g_return_val_if_fail (tz != NULL, 0);
+  g_return_val_if_fail (interval >= 0 && interval < tz->n_intervals, 0);
+
+  return tz->transitions [interval].gmtoff;
+}
+
+/**
+ * g_time_zone_is_dst:
+ * @tz: a #GTimeZone
+ * @interval: an interval from g_time_zone_find_interval()
+ *
+ * Determines if daylight savings is in effect during @interval.
+ *
+ * Return value: %TRUE if @interval is daylight savings time
+ *
+ * Since: 2.26
+ */
+gboolean
+g_time_zone_is_dst (GTimeZone *tz,       /* IN */
+                    gint       interval) /* IN */
+{
+  g_return_val_if_fail (tz != NULL, FALSE);
+  g_return_val_if_fail (interval >= 0 && interval < tz->n_intervals, FALSE);
+
+  return tz->transitions [interval].is_dst;
+}
+
+/**
+ * g_time_zone_get_abbreviation:
+ * @tz: a #GTimeZone
+ * @interval: an interval from g_time_zone_find_interval()
+ *
+ * Retrieves the abbreviation used during @interval, such as "PST".
+ *
+ * Return value: the abbreviation, owned by @tz
+ *
+ * Since: 2.26
+ */
+const gchar*
+g_time_zone_get_abbreviation (GTimeZone *tz,       /* IN */
+                              gint       interval) /* IN */
+{
+  g_return_val_if_fail (tz != NULL, NULL);
+  g_return_val_if_fail (interval >= 0 && interval < tz->n_intervals, NULL);
+
+  return tz->transitions [interval].abbr;
+}
+
+/*
+ * Leap seconds as published by the IERS, used when neither leap-seconds.list
+ * nor right/UTC can be found in the zoneinfo database.
+ */
+static const GLeapSecond builtin_leaps [] =
+{
+  {   63072000, 10 }, {   78796800, 11 }, {   94694400, 12 },
+  {  126230400, 13 }, {  157766400, 14 }, {  189302400, 15 },
+  {  220924800, 16 }, {  252460800, 17 }, {  283996800, 18 },
+  {  315532800, 19 }, {  362793600, 20 }, {  394329600, 21 },
+  {  425865600, 22 }, {  489024000, 23 }, {  567993600, 24 },
+  {  631152000, 25 }, {  662688000, 26 }, {  709948800, 27 },
+  {  741484800, 28 }, {  773020800, 29 }, {  820454400, 30 },
+  {  867715200, 31 }, {  915148800, 32 }, { 1136073600, 33 },
+  { 1230768000, 34 }, { 1341100800, 35 }, { 1435708800, 36 },
+  { 1483228800, 37 }
+};
+
+/*
+ * Reads leap-seconds.list, whose lines hold the instant from which an
+ * offset of TAI from UTC applies, in seconds since 1900, and the offset.
+ */
+static GArray*
+g_leap_seconds_load_list (const gchar *filename)
+{
+  GLeapSecond   leap;
+  GArray       *leaps;
+  gchar        *contents,
+              **lines,
+               *end;
+  gint          i;
+
+  if (!g_file_get_contents (filename, &contents, NULL, NULL))
+    return NULL;
+
+  leaps = g_array_new (FALSE, FALSE, sizeof (GLeapSecond));
+  lines = g_strsplit (contents, "\n", -1);
+
+  for (i = 0; lines [i]; i++)
+    {
+      if (lines [i][0] == '#' || lines [i][0] == '\0')
+        continue;
+
+      leap.utc = g_ascii_strtoll (lines [i], &end, 10)
+               - G_GINT64_CONSTANT (2208988800);
+      leap.offset = g_ascii_strtoll (end, &end, 10);
+      g_array_append_val (leaps, leap);
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return leaps;
+}
+
+/*
+ * Reads the leap second records of a zoneinfo file from the right/
+ * hierarchy.  Their instants count the leap seconds before them and their
+ * corrections count from the offset of 10 seconds in effect in 1972.
+ */
+static GArray*
+g_leap_seconds_load_tz_data (const gchar *filename)
+{
+  GLeapSecond   leap;
+  GTzData      *tzdata;
+  GArray       *leaps;
+  const guint8 *p;
+  gint64        occurs;
+  gint          correction = 0;
+  guint         i;
+
+  if (!(tzdata = g_tz_data_new_from_file (filename)))
+    return NULL;
+
+  leaps = g_array_new (FALSE, FALSE, sizeof (GLeapSecond));
+  leap.utc = LEAP_EPOCH;
+  leap.offset = 10;
+  g_array_append_val (leaps, leap);
+
+  for (i = 0, p = tzdata->leaps; i < tzdata->n_leaps; i++, p += tzdata->leap_size)
+    {
+      if (tzdata->leap_size == 12)
+        occurs = tzif_read_int64 (p);
+      else
+        occurs = (gint32)tzif_read_uint32 (p);
+
+      leap.utc = occurs - correction;
+      correction = (gint32)tzif_read_uint32 (p + tzdata->leap_size - 4);
+      leap.offset = 10 + correction;
+      g_array_append_val (leaps, leap);
+    }
+
+  g_tz_data_free (tzdata);
+
+  return leaps;
+}
+
+/*
+ * Builds the table of buckets from @leaps, or returns %NULL if they are not
+ * sorted changes of a second taking effect at midnight, months apart.
+ */
+static GLeapTable*
+g_leap_table_new (const GLeapSecond *leaps,
+                  guint              n_leaps)
+{
+  GLeapTable *table;
+  gint64      day,
+              last_day = -LEAP_BUCKET_DAYS;
+  gint        offset;
+  guint       i,
+              b;
+
+  if (n_leaps == 0 || leaps [0].utc > LEAP_EPOCH)
+    return NULL;
+
+  for (i = 1; i < n_leaps; i++)
+    {
+      day = (leaps [i].utc - LEAP_EPOCH) / SEC_PER_DAY;
+      if ((leaps [i].utc - LEAP_EPOCH) % SEC_PER_DAY != 0 ||
+          day < last_day + LEAP_BUCKET_DAYS ||
+          ABS (leaps [i].offset - leaps [i - 1].offset) != 1)
+        return NULL;
+      last_day = day;
+    }
+
+  table = g_new0 (GLeapTable, 1);
+  table->n_buckets = MAX (last_day, 0) / LEAP_BUCKET_DAYS + 1;
+  table->buckets = g_new (GLeapBucket, table->n_buckets);
+
+  offset = leaps [0].offset;
+  for (b = 0, i = 1; b < table->n_buckets; b++)
+    {
+      table->buckets [b].offset = offset;
+      table->buckets [b].step = 0;
+      table->buckets [b].day = LEAP_BUCKET_DAYS;
+
+      if (i == n_leaps)
+        continue;
+
+      day = (leaps [i].utc - LEAP_EPOCH) / SEC_PER_DAY;
+      if (day / LEAP_BUCKET_DAYS == b)
+        {
+          table->buckets [b].step = leaps [i].offset - offset;
+          table->buckets [b].day = day % LEAP_BUCKET_DAYS;
+          offset = leaps [i++].offset;
+        }
+    }
+
+  return table;
+}
+
+/*
+ * Loads the table of leap seconds from the zoneinfo database, preferring
+ * leap-seconds.list to right/UTC, or falls back to the built in table.
+ */
+static GLeapTable*
+g_leap_table_get (void)
+{
+  GLeapTable *table,
+             *loaded,
+             *retired;
+  GArray     *leaps;
+  gchar      *filename;
+
+  while (!(table = g_atomic_pointer_get ((gpointer*)&leap_table)))
+    {
+      loaded = NULL;
+      filename = g_tz_data_get_filename ("leap-seconds.list");
+      if (!(leaps = g_leap_seconds_load_list (filename)))
+        {
+          g_free (filename);
+          filename = g_tz_data_get_filename ("right/UTC");
+          leaps = g_leap_seconds_load_tz_data (filename);
+        }
+
+      if (leaps)
+        {
+          loaded = g_leap_table_new ((GLeapSecond*)leaps->data, leaps->len);
+          g_array_free (leaps, TRUE);
+          if (loaded)
+            g_time_zone_watch (filename);
+        }
+
+      if (!loaded)
+        loaded = g_leap_table_new (builtin_leaps, G_N_ELEMENTS (builtin_leaps));
+
+      g_free (filename);
+
+      /* Keep the table forgotten by a refresh if it did not change */
+      retired = g_atomic_pointer_get ((gpointer*)&retired_leap_table);
+      if (retired && retired->n_buckets == loaded->n_buckets &&
+          memcmp (retired->buckets, loaded->buckets,
+                  loaded->n_buckets * sizeof (GLeapBucket)) == 0)
+        {
+          g_free (loaded->buckets);
+          g_free (loaded);
+          loaded = retired;
+        }
+
+      if (g_atomic_pointer_compare_and_exchange ((gpointer*)&leap_table,
+                                                 NULL, loaded))
+        return loaded;
+
+      if (loaded != retired)
+        {
+          g_free (loaded->buckets);
+          g_free (loaded);
+        }
+    }
+
+  return table;
+}
+
+/**
+ * g_time_zone_get_tai_offset:
+ * @utc: an instant in seconds since the Epoch
+ *
+ * Retrieves the number of seconds International Atomic Time (TAI) is ahead
+ * of UTC at @utc, which is the number of leap seconds inserted before @utc
+ * plus the 10 seconds TAI was ahead when leap seconds were introduced in
+ * 1972.  The offset does not change before 1972 or after the last known
+ * leap second.
+ *
+ * Leap seconds are read from leap-seconds.list, or else right/UTC, within
+ * the zoneinfo database, and a built in table is used if neither exists.
+ *
+ * Return value: the offset of TAI from UTC in seconds
+ *
+ * Since: 2.26
+ */
+gint
+g_time_zone_get_tai_offset (gint64 utc) /* IN */
+{
+  const GLeapBucket *bucket;
+  GLeapTable        *table;
+  gint64             day;
+
+  table = g_leap_table_get ();
+  day = g_tz_floor_div (utc - LEAP_EPOCH, SEC_PER_DAY);
+  day = CLAMP (day, 0, (gint64)table->n_buckets * LEAP_BUCKET_DAYS - 1);
+  bucket = &table->buckets [day / LEAP_BUCKET_DAYS];
+
+  return bucket->offset
+       + bucket->step * (day % LEAP_BUCKET_DAYS >= bucket->day);
+}
+
+#ifdef HAVE_MMAP
+/*
+ * g_time_zone_share() copies zones into a single mapping in two passes over
+ * the same code, the first with a %NULL base only measuring its size.
+ */
+typedef struct
+{
+  guint8     *base;             /* Start of the mapping, or NULL to measure */
+  gsize       used;             /* Number of bytes handed out */
+  GHashTable *abbrs;            /* Interned abbreviation to its copy */
+} GTzShared;
+
+static gpointer
+g_tz_shared_copy (GTzShared     *shared,
+                  gconstpointer  data,
+                  gsize          size)
+{
+  gpointer mem = NULL;
+
+  shared->used = (shared->used + 7) & ~(gsize)7;
+
+  if (shared->base)
+    {
+      mem = shared->base + shared->used;
+      memcpy (mem, data, size);
+    }
+
+  shared->used += size;
+
+  return mem;
+}
+
+static GTimeZone*
+g_tz_shared_copy_zone (GTzShared *shared,
+                       GTimeZone *tz)
+{
+  GTimeZone *copy;
+  guint      i;
+
+  if (!(copy = g_tz_shared_copy (shared, tz, sizeof (GTimeZone))))
+    {
+      g_tz_shared_copy (shared, tz->identifier, strlen (tz->identifier) + 1);
+      g_tz_shared_copy (shared, tz->transitions,
+                        tz->n_intervals * sizeof (GTimeZoneTransition));
+      if (tz->rule)
+        g_tz_shared_copy (shared, tz->rule, sizeof (GTzRule));
+      return NULL;
+    }
+
+  copy->permanent = TRUE;
+
+  /* The copy is read-only once shared, so it is given its index now.  An
+   * index already given to @tz now refers to the copy, so that children
+   * looking up a #GDateTime's zone read the shared pages too */
+  g_static_mutex_lock (&index_lock);
+  if (!copy->index)
+    g_time_zone_index_insert (copy);
+  else
+    g_atomic_pointer_set ((gpointer*)&zone_index->zones [copy->index], copy);
+  g_static_mutex_unlock (&index_lock);
+
+  copy->identifier = g_tz_shared_copy (shared, tz->identifier,
+                                       strlen (tz->identifier) + 1);
+  copy->transitions = g_tz_shared_copy (shared, tz->transitions,
+                                        tz->n_intervals *
+                                        sizeof (GTimeZoneTransition));
+  for (i = 0; i < tz->n_intervals; i++)
+    copy->transitions [i].abbr = g_hash_table_lookup (shared->abbrs,
+                                                      tz->transitions [i].abbr);
+
+  if (tz->rule)
+    {
+      copy->rule = g_tz_shared_copy (shared, tz->rule, sizeof (GTzRule));
+      copy->rule->std_abbr = g_hash_table_lookup (shared->abbrs,
+                                                  tz->rule->std_abbr);
+      copy->rule->dst_abbr = g_hash_table_lookup (shared->abbrs,
+                                                  tz->rule->dst_abbr);
+    }
+
+  return copy;
+}
+
+/*
+ * Copies the registry, the local zone, the leap seconds and every
+ * abbreviation into @shared.  Returns the copy of the registry, or %NULL
+ * when measuring.
+ */
+static GTimeZoneRegistry*
+g_tz_shared_copy_all (GTzShared         *shared,
+                      GTimeZoneRegistry *reg,
+                      GTimeZone         *local,
+                      GLeapTable        *leaps,
+                      GTimeZone        **local_copy,
+                      GLeapTable       **leaps_copy)
+{
+  GTimeZoneRegistry *copy;
+  GHashTableIter     iter;
+  gpointer           abbr;
+  gchar             *abbr_copy;
+  gboolean           local_registered = FALSE;
+  guint              id;
+
+  g_hash_table_iter_init (&iter, abbrs_table);
+  while (g_hash_table_iter_next (&iter, &abbr, NULL))
+    if ((abbr_copy = g_tz_shared_copy (shared, abbr, strlen (abbr) + 1)))
+      g_hash_table_insert (shared->abbrs, abbr, abbr_copy);
+
+  copy = g_tz_shared_copy (shared, reg, sizeof (GTimeZoneRegistry));
+  if (copy)
+    {
+      copy->shared = TRUE;
+      copy->zones = g_tz_shared_copy (shared, reg->zones,
+                                      reg->size / 2 * sizeof (GTimeZone*));
+      copy->generations = g_tz_shared_copy (shared,
+                                            (gconstpointer)reg->generations,
+                                            reg->size / 2 * sizeof (gint));
+      copy->slots = g_tz_shared_copy (shared, (gconstpointer)reg->slots,
+                                      reg->size * sizeof (gint));
+    }
+  else
+    {
+      g_tz_shared_copy (shared, NULL, reg->size / 2 * sizeof (GTimeZone*));
+      g_tz_shared_copy (shared, NULL, reg->size / 2 * sizeof (gint));
+      g_tz_shared_copy (shared, NULL, reg->size * sizeof (gint));
+    }
+
+  for (id = 0; id < reg->n_zones; id++)
+    {
+      if (copy)
+        copy->zones [id] = g_tz_shared_copy_zone (shared, reg->zones [id]);
+      else
+        g_tz_shared_copy_zone (shared, reg->zones [id]);
+
+      if (reg->zones [id] == local)
+        {
+          *local_copy = copy ? copy->zones [id] : NULL;
+          local_registered = TRUE;
+        }
+    }
+
+  /* The local zone is not registered when read from /etc/localtime */
+  if (!local_registered)
+    *local_copy = g_tz_shared_copy_zone (shared, local);
+
+  if ((*leaps_copy = g_tz_shared_copy (shared, leaps, sizeof (GLeapTable))))
+    (*leaps_copy)->buckets = g_tz_shared_copy (shared, leaps->buckets,
+                                               leaps->n_buckets *
+                                               sizeof (GLeapBucket));
+  else
+    g_tz_shared_copy (shared, NULL, leaps->n_buckets * sizeof (GLeapBucket));
+
+  return copy;
+}
+#endif
+
+/**
+ * g_time_zone_share:
+ * @identifiers: a %NULL-terminated array of timezone names, or %NULL
+ *
+ * Loads the timezones named by @identifiers, the local timezone and the
+ * table of leap seconds, then moves every loaded timezone into a single
+ * read-only mapping.  A pre-fork server calls this in the parent, so that
+ * its children share the same physical pages and find these zones without
+ * loading or registering anything.  Zones loaded later are registered in
+ * each process as usual.  Without mmap() support the zones are only loaded,
+ * and children share them for as long as copy-on-write allows.
+ *
+ * Zones retrieved before the call remain valid, see g_time_zone_refresh().
+ *
+ * Since: 2.26
+ */
+void
+g_time_zone_share (const gchar **identifiers) /* IN */
+{
+#ifdef HAVE_MMAP
+  GTimeZoneRegistry *reg,
+                    *reg_copy;
+  GTimeZone         *local,
+                    *local_copy = NULL;
+  GLeapTable        *leaps,
+                    *leaps_copy = NULL;
+  GTzShared          shared;
+#endif
+  gint               i;
+
+  for (i = 0; identifiers && identifiers [i]; i++)
+    g_time_zone_new (identifiers [i]);
+
+  /* There is a registry to share even if the local zone is unregistered */
+  g_time_zone_new_utc ();
+  g_time_zone_new_local ();
+  g_leap_table_get ();
+
+#ifdef HAVE_MMAP
+  g_static_mutex_lock (&registry_lock);
+  g_static_mutex_lock (&cache_lock);
+
+  /* Give up if another thread refreshed the zones in the meantime */
+  if (!(reg = registry) || !(local = local_zone) || !(leaps = leap_table) ||
+      !abbrs_table)
+    {
+      g_static_mutex_unlock (&cache_lock);
+      g_static_mutex_unlock (&registry_lock);
+      return;
+    }
+
+  memset (&shared, 0, sizeof (GTzShared));
+  shared.abbrs = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_tz_shared_copy_all (&shared, reg, local, leaps, &local_copy, &leaps_copy);
+
+  shared.base = mmap (NULL, shared.used, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+  /* The copies are not counted by g_time_zone_get_cache_stats(), since the
+   * zones they were copied from are never freed and stay counted */
+  if (shared.base != MAP_FAILED)
+    {
+      shared.used = 0;
+      reg_copy = g_tz_shared_copy_all (&shared, reg, local, leaps,
+                                       &local_copy, &leaps_copy);
+      mprotect (shared.base, shared.used, PROT_READ);
+
+      g_atomic_pointer_set ((gpointer*)&registry, reg_copy);
+      g_atomic_pointer_set ((gpointer*)&local_zone, local_copy);
+      g_atomic_pointer_set ((gpointer*)&leap_table, leaps_copy);
+    }
+
+  g_hash_table_destroy (shared.abbrs);
+
+  g_static_mutex_unlock (&cache_lock);
+  g_static_mutex_unlock (&registry_lock);
+#endif
+}
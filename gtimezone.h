@@ -0,0 +1,127 @@
+/* gtimezone.h
+ *
+ * Copyright (C) 2009-2010 Christian Hergert <chris@dronelabs.com>
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __G_TIME_ZONE_H__
+#define __G_TIME_ZONE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GTimeType:
+ * @G_TIME_TYPE_UNIVERSAL: the time is an instant in Universal coordinated
+ *   time.
+ * @G_TIME_TYPE_LOCAL: the time is a wall clock time within the timezone.
+ *
+ * Describes how a time in seconds since the Epoch passed to
+ * g_time_zone_find_interval() should be interpreted.
+ */
+typedef enum
+{
+  G_TIME_TYPE_UNIVERSAL,
+  G_TIME_TYPE_LOCAL
+} GTimeType;
+
+/**
+ * GTimeResolve:
+ * @G_TIME_RESOLVE_EARLIER: use the earlier instant.  For skipped wall clock
+ *   times, use the offset in effect after the transition, which gives an
+ *   instant just before it.
+ * @G_TIME_RESOLVE_LATER: use the later instant.  For skipped wall clock
+ *   times, use the offset in effect before the transition, which gives an
+ *   instant just after it.
+ * @G_TIME_RESOLVE_SHIFT_FORWARD: use the earlier instant of repeated wall
+ *   clock times, and the transition itself for skipped ones.
+ * @G_TIME_RESOLVE_REJECT: fail for wall clock times that are repeated or
+ *   skipped.
+ *
+ * Describes how g_time_zone_resolve_local() picks an instant for wall clock
+ * times that occur twice when daylight savings ends, or not at all when it
+ * begins.
+ */
+typedef enum
+{
+  G_TIME_RESOLVE_EARLIER,
+  G_TIME_RESOLVE_LATER,
+  G_TIME_RESOLVE_SHIFT_FORWARD,
+  G_TIME_RESOLVE_REJECT
+} GTimeResolve;
+
+typedef struct _GTimeZone      GTimeZone;
+typedef struct _GTimeZoneDays  GTimeZoneDays;
+
+void          g_time_zone_convert_times          (GTimeZone      *tz,
+                                                  GTimeType       type,
+                                                  const gint64   *times,
+                                                  gint64         *converted,
+                                                  gsize           n_times);
+gint          g_time_zone_days_find              (GTimeZoneDays  *days,
+                                                  gint64          utc);
+void          g_time_zone_days_find_times        (GTimeZoneDays  *days,
+                                                  const gint64   *times,
+                                                  gint           *indices,
+                                                  gsize           n_times);
+void          g_time_zone_days_free              (GTimeZoneDays  *days);
+guint         g_time_zone_days_get_n_days        (GTimeZoneDays  *days);
+gint64        g_time_zone_days_get_start         (GTimeZoneDays  *days,
+                                                  guint           day);
+GTimeZoneDays *
+              g_time_zone_days_new               (GTimeZone      *tz,
+                                                  gint64          first,
+                                                  gint64          last);
+gint          g_time_zone_find_instants          (GTimeZone      *tz,
+                                                  gint64          local,
+                                                  gint64         *earlier,
+                                                  gint64         *later);
+gint          g_time_zone_find_interval          (GTimeZone      *tz,
+                                                  GTimeType       type,
+                                                  gint64          time_);
+const gchar * g_time_zone_get_abbreviation       (GTimeZone      *tz,
+                                                  gint            interval);
+void          g_time_zone_get_cache_stats        (guint          *n_zones,
+                                                  guint          *n_abbreviations,
+                                                  gsize          *n_bytes);
+const gchar * g_time_zone_get_identifier         (GTimeZone      *tz);
+guint         g_time_zone_get_index              (GTimeZone      *tz);
+GTimeZone *   g_time_zone_get_thread_default     (void);
+gint          g_time_zone_get_tai_offset         (gint64          utc);
+gint32        g_time_zone_get_offset             (GTimeZone      *tz,
+                                                  gint            interval);
+gboolean      g_time_zone_is_dst                 (GTimeZone      *tz,
+                                                  gint            interval);
+GTimeZone *   g_time_zone_lookup_index           (guint           index_);
+GTimeZone *   g_time_zone_new                    (const gchar    *identifier);
+GTimeZone *   g_time_zone_new_local              (void);
+GTimeZone *   g_time_zone_new_utc                (void);
+void          g_time_zone_pop_thread_default     (GTimeZone      *tz);
+void          g_time_zone_push_thread_default    (GTimeZone      *tz);
+GTimeZone *   g_time_zone_ref                    (GTimeZone      *tz);
+void          g_time_zone_refresh                (void);
+gboolean      g_time_zone_resolve_local          (GTimeZone      *tz,
+                                                  gint64          local,
+                                                  GTimeResolve    resolve,
+                                                  gint64         *utc);
+void          g_time_zone_share                  (const gchar   **identifiers);
+void          g_time_zone_unref                  (GTimeZone      *tz);
+gboolean      g_time_zone_watch_start            (void);
+
+G_END_DECLS
+
+#endif /* __G_TIME_ZONE_H__ */
@@ -0,0 +1,200 @@
+/* gtzabbrs-gen.c
+ *
+ * Copyright (C) 2009-2010 Christian Hergert <chris@dronelabs.com>
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Writes the timezone abbreviations understood by %Z in
+ * g_date_time_parse_with_format() as a perfect hash table to be included
+ * by gdatetime.c.
+ *
+ *   gtzabbrs-gen > gtzabbrs.h
+ *
+ * A seed is searched for that gives every abbreviation its own slot, so
+ * that a lookup is a single hash and comparison.
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SEEDS (1 << 20)
+
+typedef struct
+{
+  const gchar *abbr;
+  gint32       offset;            /* Seconds east of UTC */
+} Abbr;
+
+/*
+ * Abbreviations naming more than one offset, such as IST for India,
+ * Ireland and Israel, are left out.  CST, AST and BST are taken to be
+ * those of North America and Britain.
+ */
+static const Abbr abbrs [] =
+{
+  { "UT",     0 },
+  { "UTC",    0 },
+  { "GMT",    0 },
+  { "Z",      0 },
+
+  { "NST",   -12600 },
+  { "NDT",    -9000 },
+  { "AST",   -14400 },
+  { "ADT",   -10800 },
+  { "EST",   -18000 },
+  { "EDT",   -14400 },
+  { "CST",   -21600 },
+  { "CDT",   -18000 },
+  { "MST",   -25200 },
+  { "MDT",   -21600 },
+  { "PST",   -28800 },
+  { "PDT",   -25200 },
+  { "AKST",  -32400 },
+  { "AKDT",  -28800 },
+  { "HST",   -36000 },
+  { "HDT",   -32400 },
+
+  { "WET",    0 },
+  { "WEST",   3600 },
+  { "BST",    3600 },
+  { "CET",    3600 },
+  { "CEST",   7200 },
+  { "EET",    7200 },
+  { "EEST",   10800 },
+  { "MSK",    10800 },
+
+  { "WAT",    3600 },
+  { "CAT",    7200 },
+  { "SAST",   7200 },
+  { "EAT",    10800 },
+
+  { "PKT",    18000 },
+  { "WIB",    25200 },
+  { "WITA",   28800 },
+  { "HKT",    28800 },
+  { "WIT",    32400 },
+  { "JST",    32400 },
+  { "KST",    32400 },
+
+  { "AWST",   28800 },
+  { "ACST",   34200 },
+  { "ACDT",   37800 },
+  { "AEST",   36000 },
+  { "AEDT",   39600 },
+  { "ChST",   36000 },
+  { "NZST",   43200 },
+  { "NZDT",   46800 },
+};
+
+/* Kept in sync with the copy written to the table below */
+static guint
+hash_abbr (const gchar *abbr,
+           gsize        len,
+           guint32      seed)
+{
+  guint32 hash = seed;
+  gsize   i;
+
+  for (i = 0; i < len; i++)
+    hash = (hash ^ (guchar)abbr [i]) * 16777619U;
+
+  return hash ^ (hash >> 15);
+}
+
+/*
+ * Whether @seed gives each abbreviation its own slot in a table of @size.
+ */
+static gboolean
+try_seed (guint32  seed,
+          guint    size,
+          gint    *slots)
+{
+  guint i,
+        slot;
+
+  for (i = 0; i < size; i++)
+    slots [i] = -1;
+
+  for (i = 0; i < G_N_ELEMENTS (abbrs); i++)
+    {
+      slot = hash_abbr (abbrs [i].abbr, strlen (abbrs [i].abbr), seed) & (size - 1);
+      if (slots [slot] != -1)
+        return FALSE;
+      slots [slot] = i;
+    }
+
+  return TRUE;
+}
+
+int
+main (int   argc,
+      char *argv [])
+{
+  guint32 seed = 0;
+  guint   size,
+          i;
+  gint   *slots = NULL;
+
+  for (size = 64; size <= 65536; size *= 2)
+    {
+      slots = g_renew (gint, slots, size);
+      for (seed = 2166136261U; seed < 2166136261U + MAX_SEEDS; seed++)
+        if (try_seed (seed, size, slots))
+          break;
+      if (seed < 2166136261U + MAX_SEEDS)
+        break;
+    }
+
+  if (size > 65536)
+    {
+      fprintf (stderr, "%s: no perfect hash found\n", argv [0]);
+      return EXIT_FAILURE;
+    }
+
+  printf ("/* Generated by gtzabbrs-gen, do not edit. */\n\n");
+  printf ("#define TZ_ABBRS_SIZE (%u)\n\n", size);
+
+  printf ("static guint\n"
+          "g_tz_abbr_hash (const gchar *abbr,\n"
+          "                gsize        len)\n"
+          "{\n"
+          "  guint32 hash = %uU;\n"
+          "  gsize   i;\n"
+          "\n"
+          "  for (i = 0; i < len; i++)\n"
+          "    hash = (hash ^ (guchar)abbr [i]) * 16777619U;\n"
+          "\n"
+          "  return (hash ^ (hash >> 15)) & (TZ_ABBRS_SIZE - 1);\n"
+          "}\n\n", seed);
+
+  printf ("static const GTzAbbr tz_abbrs [TZ_ABBRS_SIZE] =\n{\n");
+  for (i = 0; i < size; i++)
+    {
+      if (slots [i] == -1)
+        printf ("  { NULL, 0 },\n");
+      else
+        printf ("  { \"%s\", %d },\n",
+                abbrs [slots [i]].abbr, abbrs [slots [i]].offset);
+    }
+  printf ("};\n");
+
+  g_free (slots);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,261 @@
+/* gtzdata-gen.c
+ *
+ * Copyright (C) 2009-2010 Christian Hergert <chris@dronelabs.com>
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Writes a snapshot of a compiled zoneinfo database as C tables to be
+ * included by gtimezone.c when built with HAVE_BUILTIN_TZDATA.
+ *
+ *   gtzdata-gen /usr/share/zoneinfo > gtzdata.h
+ *
+ * Only the 64-bit data of version 2+ files is kept, the version 1 block
+ * being replaced by an empty one, and zones which are links to each other
+ * share their data.
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TZIF_HEADER_SIZE (44)
+
+typedef struct
+{
+  gchar  *identifier;
+  guint   blob;                 /* Index of the zone's data within blobs */
+} Zone;
+
+typedef struct
+{
+  guint8 *data;
+  gsize   length;
+  guint   hash;
+} Blob;
+
+static GPtrArray *zones = NULL;
+static GPtrArray *blobs = NULL;
+
+static guint32
+read_uint32 (const guint8 *p)
+{
+  return ((guint32)p [0] << 24) |
+         ((guint32)p [1] << 16) |
+         ((guint32)p [2] <<  8) |
+         ((guint32)p [3]);
+}
+
+/*
+ * Replaces the version 1 block of a version 2+ file with an empty one, which
+ * gtimezone.c skips.  Returns %FALSE if @data is not a zoneinfo file.
+ */
+static gboolean
+compact (guint8 **data,
+         gsize   *length)
+{
+  const guint8 *p = *data;
+  guint8       *compacted;
+  gsize         block;
+
+  if (*length < TZIF_HEADER_SIZE || memcmp (p, "TZif", 4) != 0)
+    return FALSE;
+
+  if (p [4] < '2')
+    return TRUE;
+
+  block = (gsize)read_uint32 (p + 32) * 5     /* timecnt */
+        + (gsize)read_uint32 (p + 36) * 6     /* typecnt */
+        + read_uint32 (p + 40)                /* charcnt */
+        + (gsize)read_uint32 (p + 28) * 8     /* leapcnt */
+        + read_uint32 (p + 24)                /* isstdcnt */
+        + read_uint32 (p + 20);               /* isutcnt */
+
+  if (*length < 2 * TZIF_HEADER_SIZE ||
+      block > *length - 2 * TZIF_HEADER_SIZE)
+    return FALSE;
+
+  compacted = g_malloc (*length - block);
+  memcpy (compacted, p, 20);
+  memset (compacted + 20, 0, TZIF_HEADER_SIZE - 20);
+  memcpy (compacted + TZIF_HEADER_SIZE,
+          p + TZIF_HEADER_SIZE + block,
+          *length - TZIF_HEADER_SIZE - block);
+
+  g_free (*data);
+  *data = compacted;
+  *length -= block;
+
+  return TRUE;
+}
+
+static guint
+hash_data (const guint8 *data,
+           gsize         length)
+{
+  guint32 hash = 2166136261U;
+  gsize   i;
+
+  for (i = 0; i < length; i++)
+    hash = (hash ^ data [i]) * 16777619U;
+
+  return hash;
+}
+
+/*
+ * Finds the blob holding @data, adding it if no earlier zone had the same
+ * contents.  Takes ownership of @data.
+ */
+static guint
+add_blob (guint8 *data,
+          gsize   length)
+{
+  Blob *blob;
+  guint hash,
+        i;
+
+  hash = hash_data (data, length);
+
+  for (i = 0; i < blobs->len; i++)
+    {
+      blob = g_ptr_array_index (blobs, i);
+      if (blob->hash == hash && blob->length == length &&
+          memcmp (blob->data, data, length) == 0)
+        {
+          g_free (data);
+          return i;
+        }
+    }
+
+  blob = g_new0 (Blob, 1);
+  blob->data = data;
+  blob->length = length;
+  blob->hash = hash;
+  g_ptr_array_add (blobs, blob);
+
+  return blobs->len - 1;
+}
+
+static void
+add_directory (const gchar *tzdir,
+               const gchar *relative)
+{
+  const gchar *name;
+  gchar       *path,
+              *identifier,
+              *contents;
+  gsize        length;
+  GDir        *dir;
+  Zone        *zone;
+
+  path = relative ? g_build_filename (tzdir, relative, NULL) : g_strdup (tzdir);
+  dir = g_dir_open (path, 0, NULL);
+  g_free (path);
+
+  if (!dir)
+    return;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      /* These hold copies of the zones with leap seconds or under new names */
+      if (!relative && (strcmp (name, "posix") == 0 ||
+                        strcmp (name, "right") == 0 ||
+                        strcmp (name, "localtime") == 0 ||
+                        strcmp (name, "posixrules") == 0))
+        continue;
+
+      identifier = relative ? g_build_filename (relative, name, NULL)
+                            : g_strdup (name);
+      path = g_build_filename (tzdir, identifier, NULL);
+
+      if (g_file_test (path, G_FILE_TEST_IS_DIR))
+        add_directory (tzdir, identifier);
+      else if (g_file_get_contents (path, &contents, &length, NULL))
+        {
+          if (compact ((guint8**)&contents, &length))
+            {
+              zone = g_new0 (Zone, 1);
+              zone->identifier = g_strdup (identifier);
+              zone->blob = add_blob ((guint8*)contents, length);
+              g_ptr_array_add (zones, zone);
+            }
+          else
+            g_free (contents);
+        }
+
+      g_free (path);
+      g_free (identifier);
+    }
+
+  g_dir_close (dir);
+}
+
+static gint
+zone_compare (gconstpointer a,
+              gconstpointer b)
+{
+  return strcmp ((*(Zone**)a)->identifier, (*(Zone**)b)->identifier);
+}
+
+int
+main (int   argc,
+      char *argv [])
+{
+  const gchar *tzdir;
+  Blob        *blob;
+  Zone        *zone;
+  gsize        j;
+  guint        i;
+
+  tzdir = (argc > 1) ? argv [1] : "/usr/share/zoneinfo";
+
+  zones = g_ptr_array_new ();
+  blobs = g_ptr_array_new ();
+  add_directory (tzdir, NULL);
+
+  if (zones->len == 0)
+    {
+      fprintf (stderr, "%s: no zoneinfo files found in %s\n", argv [0], tzdir);
+      return EXIT_FAILURE;
+    }
+
+  /* gtimezone.c finds zones with a binary search */
+  g_ptr_array_sort (zones, zone_compare);
+
+  printf ("/* Generated by gtzdata-gen from %s, do not edit. */\n\n", tzdir);
+
+  for (i = 0; i < blobs->len; i++)
+    {
+      blob = g_ptr_array_index (blobs, i);
+      printf ("static const guint8 builtin_data_%u [] =\n{", i);
+      for (j = 0; j < blob->length; j++)
+        printf ("%s0x%02x,", (j % 12) ? " " : "\n  ", blob->data [j]);
+      printf ("\n};\n\n");
+    }
+
+  printf ("static const GTzBuiltin builtin_zones [] =\n{\n");
+  for (i = 0; i < zones->len; i++)
+    {
+      zone = g_ptr_array_index (zones, i);
+      blob = g_ptr_array_index (blobs, zone->blob);
+      printf ("  { \"%s\", builtin_data_%u, %" G_GSIZE_FORMAT " },\n",
+              zone->identifier, zone->blob, blob->length);
+    }
+  printf ("};\n");
+
+  return EXIT_SUCCESS;
+}